@@ -0,0 +1,123 @@
+#include "InfixParser.hpp"
+#include <climits>
+
+// Default constructor - no pending operators
+InfixParser::InfixParser() {}
+
+// Copy constructor - only the reusable operator buffer is copied
+InfixParser::InfixParser(const InfixParser& other) {
+    *this = other;
+}
+
+// Assignment operator - copies the operator buffer
+InfixParser& InfixParser::operator=(const InfixParser& other) {
+    if (this != &other)
+        this->operators = other.operators;
+    return *this;
+}
+
+// Destructor - operator buffer is automatically cleaned up
+InfixParser::~InfixParser() {}
+
+// '~' is unary minus, which binds tighter than any binary operator
+int InfixParser::precedence(char operation) {
+    switch (operation) {
+        case '~': return 3;
+        case '*':
+        case '/': return 2;
+        case '+':
+        case '-': return 1;
+        default:  return 0;
+    }
+}
+
+void InfixParser::emit(RPN::Program& program, RPN::Opcode op, int operand) {
+    RPN::Instruction instruction;
+    instruction.op = op;
+    instruction.operand = operand;
+    program.code.push_back(instruction);
+}
+
+// Moves the top pending operator to the output
+void InfixParser::reduce(RPN::Program& program) {
+    switch (operators.back()) {
+        case '+': emit(program, RPN::ADD, 0); break;
+        case '-': emit(program, RPN::SUB, 0); break;
+        case '*': emit(program, RPN::MUL, 0); break;
+        case '/': emit(program, RPN::DIV, 0); break;
+        case '~': emit(program, RPN::NEG, 0); break;
+        default:  throw std::runtime_error("Mismatched parentheses");
+    }
+    operators.pop_back();
+}
+
+RPN::Program InfixParser::parse(const std::string& expression) {
+    const char* cursor = expression.data();
+    const char* end = cursor + expression.size();
+    bool expectOperand = true;
+    RPN::Program program;
+
+    program.registers = RPN::VARIABLES;
+    operators.clear();
+    while (cursor != end) {
+        char c = *cursor;
+
+        if (c == ' ' || (c >= '\t' && c <= '\r')) {
+            cursor++;
+            continue;
+        }
+
+        // Operand position: numbers, variables, '(' and prefix signs
+        if (expectOperand) {
+            if (c >= '0' && c <= '9') {
+                long value = 0;
+                while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+                    value = value * 10 + (*cursor++ - '0');
+                    if (value > INT_MAX)
+                        throw std::runtime_error("Invalid input token");
+                }
+                emit(program, RPN::PUSH, static_cast<int>(value));
+                expectOperand = false;
+                continue;
+            }
+            if (c >= 'a' && c <= 'z') {
+                if (cursor + 1 != end && cursor[1] >= 'a' && cursor[1] <= 'z')
+                    throw std::runtime_error("Invalid input token");
+                emit(program, RPN::LOAD, c - 'a');
+                expectOperand = false;
+            }
+            else if (c == '(' || c == '-')
+                operators.push_back(c == '-' ? '~' : '(');
+            else if (c != '+')
+                throw std::runtime_error(precedence(c) || c == ')'
+                                         ? "Invalid expression" : "Invalid input token");
+        }
+
+        // Operator position: binary operators and ')'
+        else if (c == ')') {
+            while (!operators.empty() && operators.back() != '(')
+                reduce(program);
+            if (operators.empty())
+                throw std::runtime_error("Mismatched parentheses");
+            operators.pop_back();
+        }
+        else if (precedence(c) && c != '~') {
+            // All binary operators are left-associative
+            while (!operators.empty() && precedence(operators.back()) >= precedence(c))
+                reduce(program);
+            operators.push_back(c);
+            expectOperand = true;
+        }
+        else
+            throw std::runtime_error(c == '(' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+                                     ? "Invalid expression" : "Invalid input token");
+        cursor++;
+    }
+
+    if (expectOperand)
+        throw std::runtime_error("Invalid expression");
+    while (!operators.empty())
+        reduce(program);
+    program.depth = RPN::measureDepth(program);
+    return program;
+}
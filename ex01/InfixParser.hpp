@@ -0,0 +1,28 @@
+#pragma once
+#ifndef INFIXPARSER_HPP
+#define INFIXPARSER_HPP
+
+#include "RPN.hpp"
+
+// Shunting-yard front end: turns an infix formula with parentheses,
+// precedence and unary minus into an RPN::Program in a single pass.
+// Operands are non-negative integers or single-letter variables a-z.
+class InfixParser
+{
+private:
+    std::vector<char> operators;  // pending operators and '(' markers
+
+    static int precedence(char operation);
+    static void emit(RPN::Program& program, RPN::Opcode op, int operand);
+    void reduce(RPN::Program& program);
+
+public:
+    InfixParser();
+    ~InfixParser();
+    InfixParser(const InfixParser& other);
+    InfixParser& operator=(const InfixParser& other);
+
+    RPN::Program parse(const std::string& expression);
+};
+
+#endif
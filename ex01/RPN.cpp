@@ -1,76 +1,255 @@
 #include "RPN.hpp"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
 
-// Default constructor - initializes an empty RPN calculator
-RPN::RPN() {}
+#if RPN_PROFILE
+# define RPN_PROFILE_BEGIN() profiler.begin()
+# define RPN_PROFILE_STEP(op, value, depth) profiler.record(op, value, depth)
+# define RPN_PROFILE_END() profiler.end()
+#else
+# define RPN_PROFILE_BEGIN()
+# define RPN_PROFILE_STEP(op, value, depth)
+# define RPN_PROFILE_END()
+#endif
+
+// Bytes read from the descriptor at a time by evaluateStream()
+static const size_t STREAM_BLOCK = 1 << 20;
+// Longest token step() accepts, a digit or an operator; a longer carried
+// token is rejected before it can grow with the input
+static const size_t STREAM_TOKEN = 1;
+
+// Default constructor - starts with room for typical expressions
+RPN::RPN()
+    : cacheSlots(2 * 4096, 0), cacheNewest(NONE), cacheOldest(NONE), cacheCapacity(4096),
+      cacheHits(0), cacheMisses(0), stack(64) {}
 
 // Copy constructor - creates a deep copy of another RPN calculator
 RPN::RPN(const RPN& other) {
     *this = other;
 }
 
-// Assignment operator - performs deep copy of the stack
+// Assignment operator - performs deep copy of the stack and the cache
 RPN& RPN::operator=(const RPN& other) {
-    if (this != &other)
+    if (this != &other) {
+        this->cache = other.cache;
+        this->cacheSlots = other.cacheSlots;
+        this->cacheNewest = other.cacheNewest;
+        this->cacheOldest = other.cacheOldest;
+        this->cacheCapacity = other.cacheCapacity;
+        this->cacheHits = other.cacheHits;
+        this->cacheMisses = other.cacheMisses;
         this->stack = other.stack;
+        this->realStack = other.realStack;
+        this->registerFile = other.registerFile;
+#if RPN_PROFILE
+        this->profiler = other.profiler;
+#endif
+    }
     return *this;
 }
 
-// Destructor - stack is automatically cleaned up
+// Destructor - stack buffer is automatically cleaned up
 RPN::~RPN() {}
 
-bool RPN::isOperator(const std::string& token) const {
-    return token == "+" || token == "-" || token == "*" || token == "/";
-}
-
-int RPN::performOperation(const std::string& operation, int operand1, int operand2) const {
-    if (operation == "+") return operand1 + operand2;
-    if (operation == "-") return operand1 - operand2;
-    if (operation == "*") return operand1 * operand2;
-    if (operation == "/") {
-        // Check for division by zero
-        if (operand2 == 0) 
-            throw std::runtime_error("Division by zero");
-        return operand1 / operand2;
-    }
-    throw std::runtime_error("Invalid operator");
-}
-
-int RPN::stringToInt(const std::string& str) const {
-    std::stringstream ss(str);
-    int result;
-    
-    // Try to convert string to integer
-    ss >> result;
-    
-    // Validate the conversion and value range
-    if (ss.fail() || !ss.eof() || result < 0 || result > 9)
-        throw std::invalid_argument("Invalid integer value");
-    return result;
+// Same set as isspace() in the C locale, without the locale lookup
+static inline bool isBlank(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Skips whitespace and returns the next token span, without copying
+inline bool RPN::nextToken(const char*& cursor, const char* end, Token& token) const {
+    while (cursor != end && isBlank(*cursor))
+        cursor++;
+    if (cursor == end)
+        return false;
+    token.begin = cursor;
+    while (cursor != end && !isBlank(*cursor))
+        cursor++;
+    token.length = cursor - token.begin;
+    return true;
+}
+
+// Indexed by Opcode
+const RPN::Signature RPN::signatures[] = {
+    {0, 1}, {0, 1}, {1, 1},                     // PUSH LOAD STORE
+    {2, 1}, {2, 1}, {2, 1}, {2, 1}, {1, 1},     // ADD SUB MUL DIV NEG
+    {2, 1}, {2, 1}, {2, 1}, {2, 1}, {1, 1},     // MOD POW MIN MAX SQRT
+    {1, 2}, {2, 2}                              // DUP SWAP
+};
+
+// Operator table: one switch on the first byte, then at most one
+// comparison of the remaining bytes, however many operators there are
+bool RPN::lookupOperator(const Token& token, Opcode& operation) {
+    const char* name = token.begin;
+    switch (token.length) {
+        case 1:
+            switch (name[0]) {
+                case '+': operation = ADD; return true;
+                case '-': operation = SUB; return true;
+                case '*': operation = MUL; return true;
+                case '/': operation = DIV; return true;
+                case '%': operation = MOD; return true;
+                case '^': operation = POW; return true;
+                default:  return false;
+            }
+        case 3:
+            switch (name[0]) {
+                case 'n': operation = NEG; return name[1] == 'e' && name[2] == 'g';
+                case 'd': operation = DUP; return name[1] == 'u' && name[2] == 'p';
+                case 'm':
+                    if (name[1] == 'i' && name[2] == 'n') { operation = MIN; return true; }
+                    operation = MAX;
+                    return name[1] == 'a' && name[2] == 'x';
+                default:  return false;
+            }
+        case 4:
+            switch (name[0]) {
+                case 's':
+                    if (name[1] == 'q' && name[2] == 'r' && name[3] == 't') { operation = SQRT; return true; }
+                    operation = SWAP;
+                    return name[1] == 'w' && name[2] == 'a' && name[3] == 'p';
+                default:  return false;
+            }
+        default:
+            return false;
+    }
+}
+
+// Operands are single digits, as in the subject: "05" is not one
+inline bool RPN::parseNumber(const Token& token, int& value) const {
+    if (token.length != 1 || token.begin[0] < '0' || token.begin[0] > '9')
+        return false;
+    value = token.begin[0] - '0';
+    return true;
+}
+
+// Parses a non-negative decimal such as "7", "2.5" or ".5" in place
+bool RPN::parseReal(const Token& token, double& value) const {
+    const char* c = token.begin;
+    const char* end = token.begin + token.length;
+    double scale = 1.0;
+    bool digits = false;
+
+    value = 0.0;
+    for (; c != end && *c >= '0' && *c <= '9'; c++, digits = true)
+        value = value * 10.0 + (*c - '0');
+    if (c != end && *c == '.')
+        for (c++; c != end && *c >= '0' && *c <= '9'; c++, digits = true)
+            value += (*c - '0') * (scale /= 10.0);
+    return digits && c == end;
+}
+
+int RPN::performOperation(Opcode operation, int operand1, int operand2) const {
+    switch (operation) {
+        case ADD: return operand1 + operand2;
+        case SUB: return operand1 - operand2;
+        case MUL: return operand1 * operand2;
+        case DIV:
+            // Check for division by zero
+            if (operand2 == 0)
+                throw std::runtime_error("Division by zero");
+            return operand1 / operand2;
+        case MOD:
+            if (operand2 == 0)
+                throw std::runtime_error("Division by zero");
+            return operand1 % operand2;
+        case MIN: return operand1 < operand2 ? operand1 : operand2;
+        case MAX: return operand1 > operand2 ? operand1 : operand2;
+        default:
+            throw std::runtime_error("Invalid operator");
+    }
+}
+
+// Makes room for depth values; the buffer only ever grows
+template <typename T>
+static T* reserve(std::vector<T>& buffer, size_t depth) {
+    if (buffer.size() < depth || buffer.empty())
+        buffer.resize(depth ? depth : 1);
+    return &buffer[0];
+}
+
+// Pre-pass: deepest stack the expression reaches before anything can fail.
+// Any token starting like a number counts as a push, which is an upper bound.
+size_t RPN::measureDepth(const char* cursor, const char* end) const {
+    Token token;
+    Opcode operation;
+    size_t depth = 0;
+    size_t maxDepth = 0;
+
+    while (nextToken(cursor, end, token)) {
+        if ((token.begin[0] >= '0' && token.begin[0] <= '9') || token.begin[0] == '.') {
+            if (++depth > maxDepth)
+                maxDepth = depth;
+            continue;
+        }
+        if (!lookupOperator(token, operation))
+            break;
+        const Signature& signature = signatures[operation];
+        if (depth < static_cast<size_t>(signature.pops))
+            break;
+        depth += signature.pushes - signature.pops;
+        if (depth > maxDepth)
+            maxDepth = depth;
+    }
+    return maxDepth;
+}
+
+size_t RPN::measureDepth(const Program& program) {
+    size_t depth = 0;
+    size_t maxDepth = 0;
+
+    std::vector<Instruction>::const_iterator it = program.code.begin();
+    for (; it != program.code.end(); it++) {
+        const Signature& signature = signatures[it->op];
+        if (depth < static_cast<size_t>(signature.pops))
+            break;
+        depth += signature.pushes - signature.pops;
+        if (depth > maxDepth)
+            maxDepth = depth;
+    }
+    return maxDepth;
 }
 
 int RPN::evaluate(const std::string& expression) {
-    std::istringstream iss(expression);
-    std::string token;
+    const char* cursor = expression.data();
+    const char* end = cursor + expression.size();
+    Token token;
+    Opcode operation;
+    int value;
+
+    RPN_PROFILE_BEGIN();
+    // Grown by doubling rather than sized by a pre-pass, which cost as much
+    // as the evaluation itself; the bench's deque stack is the reference
+    int* base = reserve(stack, 64);
+    int* top = base;
+    int* limit = base + stack.size();
 
     // Process each token in the expression
-    while (iss >> token) {
+    while (nextToken(cursor, end, token)) {
         // Case 1: Token is a single digit number
-        if (isdigit(token[0]) && token.length() == 1)
-            stack.push(stringToInt(token));
+        if (parseNumber(token, value)) {
+            if (top == limit) {
+                size_t depth = top - base;
+                stack.resize(depth * 2);
+                base = &stack[0];
+                top = base + depth;
+                limit = base + stack.size();
+            }
+            *top++ = value;
+            RPN_PROFILE_STEP(PUSH, value, top - base);
+        }
         
-        // Case 2: Token is an operator
-        else if (isOperator(token)) {
+        // Case 2: Token is one of the subject's operators
+        else if (lookupOperator(token, operation) && operation <= DIV) {
             // Check if we have enough operands
-            if (stack.size() < 2) 
+            if (top - base < 2) 
                 throw std::runtime_error("Invalid expression");
             
-            // Pop operands in reverse order
-            int operand2 = stack.top(); stack.pop();  // Second operand
-            int operand1 = stack.top(); stack.pop();  // First operand
-            
-            // Perform operation and push result
-            int result = performOperation(token, operand1, operand2);
-            stack.push(result);
+            // Operands sit in order below the top, result replaces the first
+            top--;
+            top[-1] = performOperation(operation, top[-1], top[0]);
+            RPN_PROFILE_STEP(operation, top[-1], top - base);
         } 
         // Case 3: Invalid token
         else
@@ -78,8 +257,408 @@ int RPN::evaluate(const std::string& expression) {
     }
 
     // Valid RPN expression should leave exactly one number on the stack
-    if (stack.size() != 1) 
+    if (top - base != 1) 
         throw std::runtime_error("Invalid expression");
         
-    return stack.top();
+    RPN_PROFILE_END();
+    return base[0];
+}
+
+int RPN::execute(const Program& program, const int* variables) {
+    int* base = reserve(stack, program.depth);
+    int* top = base;
+
+    // Variables occupy the first registers, temporaries follow them
+    int* registers = 0;
+    if (program.registers) {
+        registers = reserve(registerFile, program.registers);
+        std::fill(registers, registers + program.registers, 0);
+        if (variables)
+            for (int i = 0; i < VARIABLES && i < program.registers; i++)
+                registers[i] = variables[i];
+    }
+
+    std::vector<Instruction>::const_iterator it = program.code.begin();
+    for (; it != program.code.end(); it++) {
+        switch (it->op) {
+            case PUSH:
+                *top++ = it->operand;
+                break;
+            case LOAD:
+                *top++ = registers[it->operand];
+                break;
+            case STORE:
+                if (top == base)
+                    throw std::runtime_error("Invalid expression");
+                registers[it->operand] = top[-1];
+                break;
+            case NEG:
+                if (top == base)
+                    throw std::runtime_error("Invalid expression");
+                top[-1] = -top[-1];
+                break;
+            case DUP:
+                if (top == base)
+                    throw std::runtime_error("Invalid expression");
+                top[0] = top[-1];
+                top++;
+                break;
+            case SWAP:
+                if (top - base < 2)
+                    throw std::runtime_error("Invalid expression");
+                std::swap(top[-1], top[-2]);
+                break;
+            default:
+                if (top - base < 2)
+                    throw std::runtime_error("Invalid expression");
+                top--;
+                top[-1] = performOperation(it->op, top[-1], top[0]);
+        }
+    }
+
+    if (top - base != 1)
+        throw std::runtime_error("Invalid expression");
+    return base[0];
+}
+
+double RPN::evaluateReal(const std::string& expression) {
+    const char* cursor = expression.data();
+    const char* end = cursor + expression.size();
+    Token token;
+    Opcode operation;
+    double value;
+
+    double* base = reserve(realStack, measureDepth(cursor, end));
+    double* top = base;
+
+    while (nextToken(cursor, end, token)) {
+        if (parseReal(token, value)) {
+            *top++ = value;
+            continue;
+        }
+        if (!lookupOperator(token, operation))
+            throw std::runtime_error("Invalid input token");
+        if (top - base < signatures[operation].pops)
+            throw std::runtime_error("Invalid expression");
+
+        switch (operation) {
+            case ADD: top--; top[-1] += top[0]; break;
+            case SUB: top--; top[-1] -= top[0]; break;
+            case MUL: top--; top[-1] *= top[0]; break;
+            case DIV:
+            case MOD:
+                top--;
+                if (top[0] == 0.0)
+                    throw std::runtime_error("Division by zero");
+                top[-1] = operation == DIV ? top[-1] / top[0] : std::fmod(top[-1], top[0]);
+                break;
+            case POW: top--; top[-1] = std::pow(top[-1], top[0]); break;
+            case MIN: top--; top[-1] = top[0] < top[-1] ? top[0] : top[-1]; break;
+            case MAX: top--; top[-1] = top[0] > top[-1] ? top[0] : top[-1]; break;
+            case NEG: top[-1] = -top[-1]; break;
+            case SQRT:
+                if (top[-1] < 0.0)
+                    throw std::runtime_error("Square root of a negative number");
+                top[-1] = std::sqrt(top[-1]);
+                break;
+            case DUP: top[0] = top[-1]; top++; break;
+            case SWAP: std::swap(top[-1], top[-2]); break;
+            default: throw std::runtime_error("Invalid operator");
+        }
+    }
+
+    if (top - base != 1)
+        throw std::runtime_error("Invalid expression");
+    return base[0];
+}
+
+RPN::Program RPN::compile(const std::string& expression, bool extended) const {
+    const char* cursor = expression.data();
+    const char* end = cursor + expression.size();
+    Token token;
+    Instruction instruction;
+    size_t depth = 0;
+    Program program;
+
+    program.registers = 0;
+    // Every token takes at least a byte and a separator
+    program.code.reserve(expression.size() / 2 + 1);
+    while (nextToken(cursor, end, token)) {
+        instruction.operand = 0;
+        if (parseNumber(token, instruction.operand)) {
+            instruction.op = PUSH;
+            depth++;
+        }
+        else if (lookupOperator(token, instruction.op)
+                 && (extended ? instruction.op != POW && instruction.op != SQRT
+                              : instruction.op <= DIV)) {
+            const Signature& signature = signatures[instruction.op];
+            if (depth < static_cast<size_t>(signature.pops))
+                throw std::runtime_error("Invalid expression");
+            depth += signature.pushes - signature.pops;
+        }
+        else
+            throw std::runtime_error("Invalid input token");
+        program.code.push_back(instruction);
+    }
+
+    if (depth != 1)
+        throw std::runtime_error("Invalid expression");
+    program.depth = measureDepth(program);
+    return program;
+}
+
+// FNV-1a over whole words, then a final mix so that every byte reaches
+// the low bits the table is indexed by
+unsigned long RPN::hashExpression(const std::string& expression) {
+    const char* data = expression.data();
+    size_t size = expression.size();
+    unsigned long hash = 14695981039346656037UL ^ size;
+    unsigned long word;
+    size_t i = 0;
+
+    for (; i + sizeof(word) <= size; i += sizeof(word)) {
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211UL;
+    }
+    for (; i < size; i++)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211UL;
+    hash ^= hash >> 32;
+    hash *= 0xff51afd7ed558ccdUL;
+    return hash ^ (hash >> 29);
+}
+
+// Slot holding the expression, or the free slot where it would go
+size_t RPN::findSlot(unsigned long hash, const std::string& expression) const {
+    size_t mask = cacheSlots.size() - 1;
+    size_t slot = hash & mask;
+
+    while (cacheSlots[slot]) {
+        const CacheEntry& entry = cache[cacheSlots[slot] - 1];
+        if (entry.hash == hash && entry.expression == expression)
+            break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void RPN::unlinkEntry(size_t entry) {
+    CacheEntry& unlinked = cache[entry];
+    if (unlinked.newer != NONE)
+        cache[unlinked.newer].older = unlinked.older;
+    else
+        cacheNewest = unlinked.older;
+    if (unlinked.older != NONE)
+        cache[unlinked.older].newer = unlinked.newer;
+    else
+        cacheOldest = unlinked.newer;
+}
+
+void RPN::linkNewest(size_t entry) {
+    cache[entry].newer = NONE;
+    cache[entry].older = cacheNewest;
+    if (cacheNewest != NONE)
+        cache[cacheNewest].newer = entry;
+    else
+        cacheOldest = entry;
+    cacheNewest = entry;
+}
+
+// Backward-shift deletion: later slots of the probe run move up into the
+// hole, so lookups never need tombstones
+void RPN::removeSlot(size_t entry) {
+    size_t mask = cacheSlots.size() - 1;
+    size_t hole = findSlot(cache[entry].hash, cache[entry].expression);
+    size_t slot = hole;
+
+    cacheSlots[hole] = 0;
+    while (true) {
+        slot = (slot + 1) & mask;
+        if (!cacheSlots[slot])
+            return;
+        size_t home = cache[cacheSlots[slot] - 1].hash & mask;
+        // The entry may move up unless its home lies after the hole
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            cacheSlots[hole] = cacheSlots[slot];
+            cacheSlots[slot] = 0;
+            hole = slot;
+        }
+    }
+}
+
+int RPN::evaluateCached(const std::string& expression) {
+    unsigned long hash = hashExpression(expression);
+    size_t slot = findSlot(hash, expression);
+
+    if (cacheSlots[slot]) {
+        size_t entry = cacheSlots[slot] - 1;
+        cacheHits++;
+        if (entry != cacheNewest) {
+            unlinkEntry(entry);
+            linkNewest(entry);
+        }
+        if (!cache[entry].error.empty())
+            throw std::runtime_error(cache[entry].error);
+        return execute(cache[entry].program);
+    }
+
+    // evaluate() reports the first error in the text, so a failure is
+    // checked again by compile(), whose syntax errors take precedence
+    cacheMisses++;
+    int result = 0;
+    std::string error;
+    try {
+        result = evaluate(expression);
+    }
+    catch (const std::runtime_error& arithmetic) {
+        try {
+            compile(expression);
+            error = arithmetic.what();
+        }
+        catch (const std::runtime_error& syntax) {
+            error = syntax.what();
+        }
+    }
+    if (cacheCapacity > 0) {
+        // A full cache recycles its least recent entry, strings and all
+        size_t entry = cache.size();
+        if (entry < cacheCapacity)
+            cache.push_back(CacheEntry());
+        else {
+            entry = cacheOldest;
+            removeSlot(entry);
+            unlinkEntry(entry);
+            slot = findSlot(hash, expression);
+        }
+        // Subject expressions have no variables, so the program folds to
+        // its result and a hit runs a single PUSH
+        Instruction folded = {PUSH, result};
+        CacheEntry& added = cache[entry];
+        added.expression = expression;
+        added.hash = hash;
+        added.error = error;
+        added.program.code.assign(1, folded);
+        added.program.registers = 0;
+        added.program.depth = 1;
+        cacheSlots[slot] = entry + 1;
+        linkNewest(entry);
+    }
+    if (!error.empty())
+        throw std::runtime_error(error);
+    return result;
+}
+
+// Keeps the most recent entries that fit and rebuilds the table around them
+void RPN::setCacheCapacity(size_t capacity) {
+    std::vector<CacheEntry> kept;
+    for (size_t entry = cacheNewest; entry != NONE && kept.size() < capacity;
+         entry = cache[entry].older)
+        kept.push_back(cache[entry]);
+
+    size_t slots = 2;
+    while (slots < 2 * capacity)
+        slots *= 2;
+    cacheCapacity = capacity;
+    cache.swap(kept);
+    cacheSlots.assign(slots, 0);
+    cacheNewest = NONE;
+    cacheOldest = NONE;
+    for (size_t entry = cache.size(); entry-- > 0;) {
+        linkNewest(entry);
+        cacheSlots[findSlot(cache[entry].hash, cache[entry].expression)] = entry + 1;
+    }
+}
+
+size_t RPN::getCacheHits() const {
+    return cacheHits;
+}
+
+size_t RPN::getCacheMisses() const {
+    return cacheMisses;
+}
+
+// Applies one subject token to stack[0..depth), growing the stack as needed
+void RPN::step(const Token& token, size_t& depth) {
+    Opcode operation;
+    int value;
+
+    if (parseNumber(token, value)) {
+        if (depth == stack.size())
+            stack.resize(depth * 2);
+        stack[depth++] = value;
+        RPN_PROFILE_STEP(PUSH, value, depth);
+    }
+    else if (lookupOperator(token, operation) && operation <= DIV) {
+        if (depth < 2)
+            throw std::runtime_error("Invalid expression");
+        depth--;
+        stack[depth - 1] = performOperation(operation, stack[depth - 1], stack[depth]);
+        RPN_PROFILE_STEP(operation, stack[depth - 1], depth);
+    }
+    else
+        throw std::runtime_error("Invalid input token");
+}
+
+int RPN::evaluateStream(int fd) {
+    std::vector<char> block(STREAM_BLOCK);
+    std::string partial;  // token cut by the end of the previous block
+    Token token;
+    size_t depth = 0;
+    ssize_t count;
+
+    RPN_PROFILE_BEGIN();
+    reserve(stack, 1);
+    while ((count = read(fd, &block[0], block.size())) != 0) {
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Read error: ") + strerror(errno));
+        }
+        const char* cursor = &block[0];
+        const char* end = cursor + count;
+
+        // Complete the carried token with the head of this block
+        if (!partial.empty()) {
+            const char* tail = cursor;
+            while (tail != end && !isBlank(*tail))
+                tail++;
+            partial.append(cursor, tail);
+            if (partial.size() > STREAM_TOKEN)
+                throw std::runtime_error("Invalid input token");
+            cursor = tail;
+            if (cursor == end)
+                continue;
+            token.begin = partial.data();
+            token.length = partial.size();
+            step(token, depth);
+            partial.clear();
+        }
+
+        while (nextToken(cursor, end, token)) {
+            // A token touching the block edge may continue in the next one
+            if (cursor == end) {
+                if (token.length > STREAM_TOKEN)
+                    throw std::runtime_error("Invalid input token");
+                partial.assign(token.begin, token.length);
+                break;
+            }
+            step(token, depth);
+        }
+    }
+    if (!partial.empty()) {
+        token.begin = partial.data();
+        token.length = partial.size();
+        step(token, depth);
+    }
+
+    if (depth != 1)
+        throw std::runtime_error("Invalid expression");
+    RPN_PROFILE_END();
+    return stack[0];
+}
+
+#if RPN_PROFILE
+const RPNProfiler& RPN::getProfiler() const {
+    return profiler;
 }
+#endif
@@ -2,19 +2,112 @@
 #ifndef RPN_HPP
 #define RPN_HPP
 
-#include <stack>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
 #include <string>
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <vector>
+#include "RPNProfiler.hpp"
 
 class RPN 
 {
+public:
+    // Instruction set shared by the compiled forms of an expression
+    enum Opcode {
+        PUSH,   // push operand as a constant
+        LOAD,   // push register operand (0-25 are the variables a-z)
+        STORE,  // copy the top of the stack into register operand
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        NEG,    // unary minus
+        MOD,
+        POW,
+        MIN,
+        MAX,
+        SQRT,
+        DUP,
+        SWAP
+    };
+
+    // How many values an opcode takes from and leaves on the stack
+    struct Signature {
+        int pops;
+        int pushes;
+    };
+
+    static const Signature signatures[];
+
+    struct Instruction {
+        Opcode op;
+        int operand;
+    };
+
+    // A validated expression: straight-line code plus the resources it needs
+    struct Program {
+        std::vector<Instruction> code;
+        int registers;
+        size_t depth;   // deepest stack the code reaches, see measureDepth()
+    };
+
+    static const int VARIABLES = 26;
+
 private:
-    std::stack<int> stack;
-    bool isOperator(const std::string& token) const;
-    int performOperation(const std::string& operation, int operand1, int operand2) const;
-    int stringToInt(const std::string& str) const;
+    // A token is a span of the expression, never a copy of it
+    struct Token {
+        const char* begin;
+        size_t length;
+    };
+
+    // A compiled expression in the cache. Entries link up in recency
+    // order by index, so copies of the cache need no fixing up.
+    struct CacheEntry {
+        std::string expression;
+        unsigned long hash;
+        Program program;
+        std::string error;  // what() of the failure, empty if it evaluates
+        size_t newer;
+        size_t older;
+    };
+
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    std::vector<CacheEntry> cache;
+    // Open-addressing table of entry index + 1, 0 for a free slot, linear
+    // probing, at most half full
+    std::vector<size_t> cacheSlots;
+    size_t cacheNewest;
+    size_t cacheOldest;
+    size_t cacheCapacity;
+    size_t cacheHits;
+    size_t cacheMisses;
+
+    static unsigned long hashExpression(const std::string& expression);
+    size_t findSlot(unsigned long hash, const std::string& expression) const;
+    void unlinkEntry(size_t entry);
+    void linkNewest(size_t entry);
+    void removeSlot(size_t entry);
+
+#if RPN_PROFILE
+    RPNProfiler profiler;
+#endif
+
+    // Contiguous evaluation stacks, never shrunk. evaluate() doubles stack
+    // as it fills; the other evaluators size theirs with a depth pre-pass.
+    std::vector<int> stack;
+    std::vector<double> realStack;
+    std::vector<int> registerFile;
+    size_t measureDepth(const char* cursor, const char* end) const;
+    bool nextToken(const char*& cursor, const char* end, Token& token) const;
+    static bool lookupOperator(const Token& token, Opcode& operation);
+    bool parseNumber(const Token& token, int& value) const;
+    bool parseReal(const Token& token, double& value) const;
+    int performOperation(Opcode operation, int operand1, int operand2) const;
+    void step(const Token& token, size_t& depth);
 
 public:
     RPN();
@@ -22,6 +115,32 @@ public:
     RPN(const RPN& other);
     RPN& operator=(const RPN& other);
     int evaluate(const std::string& expression);
+    double evaluateReal(const std::string& expression);
+
+    // Reads a subject expression from fd in large blocks. Memory use is
+    // bounded by the stack depth, not by the length of the expression.
+    int evaluateStream(int fd);
+    int execute(const Program& program, const int* variables = 0);
+
+    // Validated, pre-tokenized form of a subject expression. extended also
+    // admits every operator execute() implements: % neg min max dup swap.
+    Program compile(const std::string& expression, bool extended = false) const;
+
+    // Deepest stack the code reaches before it could underflow; producers
+    // of a Program store it in Program::depth
+    static size_t measureDepth(const Program& program);
+
+    // Like evaluate(), but repeated expressions skip tokenizing, validation
+    // and arithmetic: a cached expression is folded to its result, or to
+    // its error. Syntax errors are reported before any arithmetic error.
+    int evaluateCached(const std::string& expression);
+    void setCacheCapacity(size_t capacity);
+    size_t getCacheHits() const;
+    size_t getCacheMisses() const;
+
+#if RPN_PROFILE
+    const RPNProfiler& getProfiler() const;
+#endif
 };
 
 #endif
@@ -0,0 +1,409 @@
+#include "RPN.hpp"
+#include "RPNOptimizer.hpp"
+#include "RPNJit.hpp"
+#include "InfixParser.hpp"
+#include "RPNGenerator.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <new>
+#include <stack>
+#include <unistd.h>
+
+// Benchmark and correctness check for every evaluation path in ex01.
+// Results are compared with RPNGenerator's reference evaluation.
+
+static int failures = 0;
+
+// Every operator new in the benchmark is counted, so the evaluators that
+// promise no heap allocation once warmed up can be held to it. Kept out of
+// line, or GCC pairs the inlined free() with new and rejects the mismatch.
+static unsigned long allocations = 0;
+
+__attribute__((noinline)) void* operator new(std::size_t size) throw(std::bad_alloc) {
+    allocations++;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+__attribute__((noinline)) void operator delete(void* memory) throw() {
+    std::free(memory);
+}
+
+// One way of evaluating an expression
+class Runner
+{
+public:
+    virtual ~Runner() {}
+    virtual int run() = 0;
+};
+
+class EvaluateRunner : public Runner
+{
+    RPN& rpn;
+    const std::string& text;
+public:
+    EvaluateRunner(RPN& rpn, const std::string& text) : rpn(rpn), text(text) {}
+    int run() { return rpn.evaluate(text); }
+};
+
+// Reference path: the baseline's std::stack over std::deque, with the same
+// in-place tokens as evaluate, so only the stack differs
+class DequeRunner : public Runner
+{
+    const std::string& text;
+public:
+    DequeRunner(const std::string& text) : text(text) {}
+    int run() {
+        std::stack<int> stack;
+        const char* cursor = text.data();
+        const char* end = cursor + text.size();
+
+        while (cursor != end) {
+            if (*cursor == ' ' || (*cursor >= '\t' && *cursor <= '\r')) {
+                cursor++;
+                continue;
+            }
+            const char* token = cursor;
+            while (cursor != end && *cursor != ' ' && (*cursor < '\t' || *cursor > '\r'))
+                cursor++;
+            char c = *token;
+            if (cursor - token != 1)
+                throw std::runtime_error("Invalid input token");
+            if (c >= '0' && c <= '9') {
+                stack.push(c - '0');
+                continue;
+            }
+            if (c != '+' && c != '-' && c != '*' && c != '/')
+                throw std::runtime_error("Invalid input token");
+            if (stack.size() < 2)
+                throw std::runtime_error("Invalid expression");
+            int operand2 = stack.top(); stack.pop();
+            int operand1 = stack.top(); stack.pop();
+            if (c == '/' && operand2 == 0)
+                throw std::runtime_error("Division by zero");
+            stack.push(c == '+' ? operand1 + operand2 : c == '-' ? operand1 - operand2
+                       : c == '*' ? operand1 * operand2 : operand1 / operand2);
+        }
+        if (stack.size() != 1)
+            throw std::runtime_error("Invalid expression");
+        return stack.top();
+    }
+};
+
+class CachedRunner : public Runner
+{
+    RPN& rpn;
+    const std::string& text;
+public:
+    CachedRunner(RPN& rpn, const std::string& text) : rpn(rpn), text(text) {}
+    int run() { return rpn.evaluateCached(text); }
+};
+
+class RealRunner : public Runner
+{
+    RPN& rpn;
+    const std::string& text;
+public:
+    RealRunner(RPN& rpn, const std::string& text) : rpn(rpn), text(text) {}
+    int run() { return static_cast<int>(rpn.evaluateReal(text)); }
+};
+
+// Returns 1 when evaluateReal matches the expected double exactly: the
+// reference does the same operations in the same order
+class RealCheckRunner : public Runner
+{
+    RPN& rpn;
+    const std::string& text;
+    double expected;
+public:
+    RealCheckRunner(RPN& rpn, const std::string& text, double expected)
+        : rpn(rpn), text(text), expected(expected) {}
+    int run() { return rpn.evaluateReal(text) == expected ? 1 : 0; }
+};
+
+// Runs a program compiled ahead of time; compile errors are replayed
+class ProgramRunner : public Runner
+{
+    RPN& rpn;
+    RPN::Program program;
+    std::string error;
+    const int* variables;
+public:
+    ProgramRunner(RPN& rpn, const RPN::Program& program, const std::string& error,
+                  const int* variables)
+        : rpn(rpn), program(program), error(error), variables(variables) {}
+    int run() {
+        if (!error.empty())
+            throw std::runtime_error(error);
+        return rpn.execute(program, variables);
+    }
+};
+
+class JitRunner : public Runner
+{
+    RPNJit& jit;
+    const int* variables;
+public:
+    JitRunner(RPNJit& jit, const int* variables) : jit(jit), variables(variables) {}
+    int run() { return jit.run(variables); }
+};
+
+class InfixRunner : public Runner
+{
+    RPN& rpn;
+    InfixParser parser;
+    const std::string& text;
+    const int* variables;
+public:
+    InfixRunner(RPN& rpn, const std::string& text, const int* variables)
+        : rpn(rpn), text(text), variables(variables) {}
+    int run() { return rpn.execute(parser.parse(text), variables); }
+};
+
+class StreamRunner : public Runner
+{
+    RPN& rpn;
+    FILE* file;
+public:
+    StreamRunner(RPN& rpn, const std::string& text) : rpn(rpn), file(std::tmpfile()) {
+        if (!file)
+            throw std::runtime_error("Cannot create a temporary file");
+        std::fwrite(text.data(), 1, text.size(), file);
+        std::fflush(file);
+    }
+    ~StreamRunner() { std::fclose(file); }
+    int run() {
+        lseek(fileno(file), 0, SEEK_SET);
+        return rpn.evaluateStream(fileno(file));
+    }
+};
+
+// Repeats the runner for at least 200 ms of CPU time after one warmup
+// run, checks the outcome and prints one result line. An allocationFree
+// runner fails the check if a valid case allocates after the warmup.
+// Returns the time per token in nanoseconds.
+static double measure(const char* shape, const char* name, Runner& runner,
+                    const RPNGenerator::Case& expected, bool check,
+                    bool allocationFree = false) {
+    long runs = 0;
+    int result = 0;
+    std::string error;
+
+    try {
+        runner.run();
+    }
+    catch (const std::exception&) {
+    }
+    unsigned long allocated = allocations;
+    std::clock_t start = std::clock();
+    std::clock_t elapsed;
+    do {
+        error.clear();
+        try {
+            result = runner.run();
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        runs++;
+        elapsed = std::clock() - start;
+    } while (elapsed < CLOCKS_PER_SEC / 5);
+    double perRun = static_cast<double>(allocations - allocated) / runs;
+
+    bool ok = expected.valid ? error.empty() && result == expected.expected
+                             : error == expected.error;
+    bool leanEnough = !allocationFree || !expected.valid || allocations == allocated;
+    double nanoseconds = elapsed * 1e9 / CLOCKS_PER_SEC / runs / expected.tokens;
+    std::cout << std::setw(16) << std::left << shape << std::setw(18) << name
+              << std::setw(10) << expected.tokens << std::setw(12) << std::fixed
+              << std::setprecision(2) << nanoseconds << std::setw(12) << perRun
+              << (check ? (ok && leanEnough ? "OK" : "KO") : "-") << std::endl;
+    if (!leanEnough) {
+        failures++;
+        std::cout << "    expected no allocation, got " << perRun << " per run" << std::endl;
+    }
+    if (check && !ok) {
+        failures++;
+        std::cout << "    expected " << (expected.valid ? "" : expected.error);
+        if (expected.valid)
+            std::cout << expected.expected;
+        std::cout << ", got " << (error.empty() ? "" : error);
+        if (error.empty())
+            std::cout << result;
+        std::cout << std::endl;
+    }
+    return nanoseconds;
+}
+
+// One line comparing two rows of a shape, faster first
+static void speedup(const char* shape, const char* what, double baseline, double faster) {
+    std::cout << std::setw(16) << std::left << shape << what << ": " << std::fixed
+              << std::setprecision(1) << baseline / faster << "x" << std::endl;
+}
+
+// Returns the time per token of evaluate, the baseline the jit is held to
+static double benchSubject(const char* shape, const RPNGenerator::Case& c) {
+    RPN rpn;
+    EvaluateRunner evaluate(rpn, c.rpn);
+    DequeRunner deque(c.rpn);
+    CachedRunner cached(rpn, c.rpn);
+    StreamRunner stream(rpn, c.rpn);
+
+    RPN::Program program;
+    std::string error;
+    program.registers = 0;
+    program.depth = 0;
+    try {
+        program = rpn.compile(c.rpn);
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+    }
+    ProgramRunner compiled(rpn, program, error, 0);
+
+    double evaluated = measure(shape, "evaluate", evaluate, c, true, true);
+    measure(shape, "deque stack", deque, c, true);
+    measure(shape, "evaluateCached", cached, c, true, true);
+    measure(shape, "compile+execute", compiled, c, true, true);
+    measure(shape, "evaluateStream", stream, c, true);
+    if (c.valid) {
+        RealRunner real(rpn, c.rpn);
+        measure(shape, "evaluateReal", real, c, false);
+    }
+    return evaluated;
+}
+
+// Each speedup compares rows running the same program, except jit vs
+// evaluate, which holds the unoptimized jit to evaluate's ns/token
+// (evaluated is 0 when the shape has variables and evaluate cannot run it)
+static void benchCompiled(const char* shape, const RPNGenerator::Case& c, const int* variables,
+                          double evaluated) {
+    RPN rpn;
+    RPNOptimizer optimizer;
+    RPN::Program program = optimizer.optimize(c.rpn);
+    ProgramRunner optimized(rpn, program, "", variables);
+    RPNOptimizer literal;
+    literal.setSimplify(false);
+    RPN::Program plain = literal.optimize(c.rpn);
+    ProgramRunner unoptimized(rpn, plain, "", variables);
+    RPNJit jit(program);
+    JitRunner native(jit, variables);
+    RPNJit plainJit(plain);
+    JitRunner plainNative(plainJit, variables);
+    InfixRunner infix(rpn, c.infix, variables);
+
+    std::cout << std::setw(16) << std::left << shape << "optimizer: " << optimizer.getTokenCount()
+              << " tokens -> " << optimizer.getNodeCount() << " nodes" << std::endl;
+    double before = measure(shape, "unoptimized", unoptimized, c, true, true);
+    double after = measure(shape, "optimized", optimized, c, true, true);
+    speedup(shape, "optimizer speedup", before, after);
+    double compiled = measure(shape, plainJit.isNative() ? "unoptimized jit" : "unopt. fallback",
+                              plainNative, c, true, true);
+    speedup(shape, "jit vs execute", before, compiled);
+    if (evaluated > 0)
+        speedup(shape, "jit vs evaluate", evaluated, compiled);
+    double folded = measure(shape, jit.isNative() ? "jit" : "jit (fallback)", native, c, true, true);
+    // A folded constant takes no measurable time either way
+    if (program.code.size() > 1)
+        speedup(shape, "optimized jit vs execute", after, folded);
+    measure(shape, "infix+execute", infix, c, true);
+}
+
+// Operators beyond the subject's + - * /. execute() has no ^ or sqrt, so
+// a level 2 shape only runs through evaluateReal.
+static void benchExtended(const char* shape, const RPNGenerator::Case& c, int level) {
+    RPN rpn;
+    RPNGenerator::Case matched = c;
+    matched.expected = 1;
+    RealCheckRunner real(rpn, c.rpn, c.expectedReal);
+
+    measure(shape, "evaluateReal", real, matched, true, true);
+    if (level > 1)
+        return;
+    ProgramRunner compiled(rpn, rpn.compile(c.rpn, true), "", 0);
+    measure(shape, "compile+execute", compiled, c, true, true);
+}
+
+// Zipf(1) stream over a few thousand short expressions
+static void benchCache() {
+    RPNGenerator generator(7);
+    RPNGenerator::Shape shape = {"zipf", 12, 6, 50, {1, 1, 1, 1}, false, 0};
+    std::vector<RPNGenerator::Case> cases;
+    std::vector<double> cumulative;
+    double total = 0;
+
+    for (int i = 0; i < 3000; i++) {
+        cases.push_back(generator.generate(shape));
+        total += 1.0 / (i + 1);
+        cumulative.push_back(total);
+    }
+    std::vector<size_t> stream(1000000);
+    for (size_t i = 0; i < stream.size(); i++) {
+        double u = static_cast<double>(std::rand()) / RAND_MAX * total;
+        stream[i] = std::lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+        if (stream[i] >= cases.size())
+            stream[i] = cases.size() - 1;
+    }
+
+    RPN rpn;
+    rpn.setCacheCapacity(1024);
+    double seconds[2];
+    for (int cached = 0; cached < 2; cached++) {
+        std::clock_t start = std::clock();
+        for (size_t i = 0; i < stream.size(); i++) {
+            const RPNGenerator::Case& c = cases[stream[i]];
+            int result = cached ? rpn.evaluateCached(c.rpn) : rpn.evaluate(c.rpn);
+            if (result != c.expected)
+                failures++;
+        }
+        seconds[cached] = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    }
+    std::cout << "zipf cache      1M lookups over 3000 expressions, capacity 1024: "
+              << seconds[0] << " s uncached, " << seconds[1] << " s cached, "
+              << rpn.getCacheHits() << " hits, " << rpn.getCacheMisses() << " misses" << std::endl;
+}
+
+int main() {
+    RPNGenerator::Shape shapes[] = {
+        {"short",      16,      8,       50,  {1, 1, 1, 1}, false, 0},
+        {"flat",       1000000, 2,       100, {4, 4, 1, 1}, false, 0},
+        {"deep",       1000000, 1000000, 100, {4, 4, 1, 1}, false, 0},
+        {"random",     1000000, 64,      50,  {1, 1, 1, 1}, false, 0},
+        {"additive",   1000000, 64,      50,  {1, 1, 0, 0}, false, 0},
+        {"variables",  100000,  64,      50,  {1, 1, 1, 1}, true, 0},
+        {"extended",   1000000, 64,      50,  {1, 1, 1, 1}, false, 1},
+        {"real",       1000000, 64,      50,  {1, 1, 1, 1}, false, 2},
+    };
+    RPNGenerator generator;
+
+    std::cout << std::setw(16) << std::left << "shape" << std::setw(18) << "evaluator"
+              << std::setw(10) << "tokens" << std::setw(12) << "ns/token" << std::setw(12) << "allocs/run"
+              << "check" << std::endl;
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        RPNGenerator::Case valid = generator.generate(shapes[i]);
+        if (shapes[i].extended) {
+            benchExtended(shapes[i].name, valid, shapes[i].extended);
+            continue;
+        }
+        double evaluated = 0;
+        if (!shapes[i].variables) {
+            evaluated = benchSubject(shapes[i].name, valid);
+            RPNGenerator::Case invalid = generator.corrupt(valid);
+            benchSubject((std::string(shapes[i].name) + " (bad)").c_str(), invalid);
+        }
+        benchCompiled(shapes[i].name, valid, generator.getVariables(), evaluated);
+    }
+    benchCache();
+
+    if (failures) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,303 @@
+#include "RPNGenerator.hpp"
+#include <climits>
+#include <cmath>
+
+// Seeded constructor - same seed, same expressions
+RPNGenerator::RPNGenerator(unsigned long seed) : state(seed ? seed : 1) {
+    for (int i = 0; i < 26; i++)
+        variables[i] = static_cast<int>(below(19)) - 9;
+}
+
+// Copy constructor - continues the same random sequence
+RPNGenerator::RPNGenerator(const RPNGenerator& other) {
+    *this = other;
+}
+
+// Assignment operator - copies the random state and the variable values
+RPNGenerator& RPNGenerator::operator=(const RPNGenerator& other) {
+    if (this != &other) {
+        state = other.state;
+        for (int i = 0; i < 26; i++)
+            variables[i] = other.variables[i];
+    }
+    return *this;
+}
+
+// Destructor - nothing to release
+RPNGenerator::~RPNGenerator() {}
+
+// xorshift64
+unsigned long RPNGenerator::next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+size_t RPNGenerator::below(size_t bound) {
+    return next() % bound;
+}
+
+// Reference arithmetic: wraps like two's complement instead of overflowing
+int RPNGenerator::apply(char operation, int operand1, int operand2) {
+    unsigned int a = static_cast<unsigned int>(operand1);
+    unsigned int b = static_cast<unsigned int>(operand2);
+    switch (operation) {
+        case '+': return static_cast<int>(a + b);
+        case '-': return static_cast<int>(a - b);
+        case '*': return static_cast<int>(a * b);
+        default:  return operand1 / operand2;
+    }
+}
+
+RPNGenerator::Case RPNGenerator::generate(const Shape& shape) {
+    if (shape.extended)
+        return generateExtended(shape);
+
+    std::vector<Node> nodes;
+    std::vector<int> operands;   // node indices on the simulated stack
+    std::vector<int> values;     // their reference values
+    size_t remaining = shape.operands ? shape.operands : 1;
+    int totalWeight = shape.weights[0] + shape.weights[1] + shape.weights[2] + shape.weights[3];
+    Case result;
+
+    result.rpn.reserve(remaining * 4);
+    while (remaining || operands.size() > 1) {
+        bool canPush = remaining && operands.size() < (shape.maxDepth ? shape.maxDepth : 1);
+        bool canPop = operands.size() >= 2;
+        Node node;
+
+        if (canPush && (!canPop || static_cast<int>(below(100)) < shape.pushPercent)) {
+            if (shape.variables && below(2)) {
+                node.token = static_cast<char>('a' + below(26));
+                values.push_back(variables[node.token - 'a']);
+            }
+            else {
+                node.token = static_cast<char>('0' + below(10));
+                values.push_back(node.token - '0');
+            }
+            node.left = -1;
+            node.right = -1;
+            remaining--;
+        }
+        else {
+            int pick = totalWeight > 0 ? static_cast<int>(below(totalWeight)) : 0;
+            int op = 0;
+            while (op < 3 && pick >= shape.weights[op])
+                pick -= shape.weights[op++];
+            node.token = "+-*/"[op];
+
+            int operand2 = values.back(); values.pop_back();
+            int operand1 = values.back(); values.pop_back();
+            // Valid expressions never divide by zero or trap on INT_MIN / -1
+            if (node.token == '/' && (operand2 == 0 || (operand1 == INT_MIN && operand2 == -1)))
+                node.token = '+';
+            values.push_back(apply(node.token, operand1, operand2));
+            node.right = operands.back(); operands.pop_back();
+            node.left = operands.back(); operands.pop_back();
+        }
+        nodes.push_back(node);
+        operands.push_back(nodes.size() - 1);
+        if (!result.rpn.empty())
+            result.rpn += ' ';
+        result.rpn += node.token;
+    }
+
+    result.infix = toInfix(nodes);
+    result.tokens = nodes.size();
+    result.valid = true;
+    result.expected = values.back();
+    result.expectedReal = 0.0;
+    return result;
+}
+
+// Unary operators ignore operand2
+int RPNGenerator::applyExtended(const std::string& operation, int operand1, int operand2) {
+    if (operation == "%")
+        return operand1 % operand2;
+    if (operation == "neg")
+        return static_cast<int>(0u - static_cast<unsigned int>(operand1));
+    if (operation == "min")
+        return operand1 < operand2 ? operand1 : operand2;
+    if (operation == "max")
+        return operand1 > operand2 ? operand1 : operand2;
+    return apply(operation[0], operand1, operand2);
+}
+
+// Same operations, in the same order, as RPN::evaluateReal
+double RPNGenerator::applyReal(const std::string& operation, double operand1, double operand2) {
+    if (operation == "+")
+        return operand1 + operand2;
+    if (operation == "-")
+        return operand1 - operand2;
+    if (operation == "*")
+        return operand1 * operand2;
+    if (operation == "/")
+        return operand1 / operand2;
+    if (operation == "%")
+        return std::fmod(operand1, operand2);
+    if (operation == "^")
+        return std::pow(operand1, operand2);
+    if (operation == "min")
+        return operand2 < operand1 ? operand2 : operand1;
+    if (operation == "max")
+        return operand2 > operand1 ? operand2 : operand1;
+    if (operation == "neg")
+        return -operand1;
+    return std::sqrt(operand1);
+}
+
+// Every operator of the shape's level is equally likely and the weights
+// are ignored. The expression is tracked twice, in wrapping int arithmetic
+// for RPN::execute and in doubles for RPN::evaluateReal; level 2 has no
+// int result. An operator that would fail or leave a double beyond 1e12
+// in magnitude, where the two could part ways, is swapped for a safe one.
+RPNGenerator::Case RPNGenerator::generateExtended(const Shape& shape) {
+    static const char* const operators[] = {
+        "+", "-", "*", "/", "%", "min", "max", "neg", "dup", "swap",  // level 1
+        "^", "sqrt"                                                    // level 2
+    };
+    static const double LIMIT = 1e12;
+    size_t count = shape.extended > 1 ? 12 : 10;
+    size_t maxDepth = shape.maxDepth > 2 ? shape.maxDepth : 2;
+    size_t remaining = shape.operands ? shape.operands : 1;
+    std::vector<int> values;
+    std::vector<double> reals;
+    Case result;
+
+    result.rpn.reserve(remaining * 4);
+    result.tokens = 0;
+    while (remaining || reals.size() > 1) {
+        size_t depth = reals.size();
+        std::string token;
+
+        if (remaining && depth < maxDepth && (depth < 2 || static_cast<int>(below(100)) < shape.pushPercent)) {
+            token = static_cast<char>('0' + below(10));
+            values.push_back(token[0] - '0');
+            reals.push_back(token[0] - '0');
+            remaining--;
+        }
+        else {
+            // Once the operands run out, only binary operators make progress
+            do
+                token = operators[below(count)];
+            while ((token == "dup" && (!remaining || depth >= maxDepth))
+                   || (!remaining && (token == "neg" || token == "sqrt" || token == "swap")));
+
+            if (token == "dup") {
+                values.push_back(values.back());
+                reals.push_back(reals.back());
+            }
+            else if (token == "swap") {
+                std::swap(values[depth - 1], values[depth - 2]);
+                std::swap(reals[depth - 1], reals[depth - 2]);
+            }
+            else {
+                bool unary = token == "neg" || token == "sqrt";
+                int operand2 = unary ? 0 : values.back();
+                double real2 = unary ? 0.0 : reals.back();
+                if (!unary) {
+                    values.pop_back();
+                    reals.pop_back();
+                }
+                int operand1 = values.back();
+                double real1 = reals.back();
+
+                if ((token == "/" || token == "%")
+                    && (operand2 == 0 || real2 == 0.0 || (operand1 == INT_MIN && operand2 == -1)))
+                    token = "+";
+                if (token == "sqrt" && real1 < 0.0)
+                    token = "neg";
+                double real = applyReal(token, real1, real2);
+                if (!(std::fabs(real) <= LIMIT)) {
+                    token = "min";
+                    real = applyReal(token, real1, real2);
+                }
+                reals.back() = real;
+                if (shape.extended < 2)
+                    values.back() = applyExtended(token, operand1, operand2);
+            }
+        }
+        if (!result.rpn.empty())
+            result.rpn += ' ';
+        result.rpn += token;
+        result.tokens++;
+    }
+
+    result.valid = true;
+    result.expected = shape.extended < 2 ? values.back() : 0;
+    result.expectedReal = reals.back();
+    return result;
+}
+
+// Fully parenthesized in-order walk, iterative so deep trees are fine
+std::string RPNGenerator::toInfix(const std::vector<Node>& nodes) {
+    std::string infix;
+    std::vector< std::pair<int, int> > work;  // node, visit phase
+
+    infix.reserve(nodes.size() * 4);
+    work.push_back(std::make_pair(static_cast<int>(nodes.size()) - 1, 0));
+    while (!work.empty()) {
+        int index = work.back().first;
+        int phase = work.back().second;
+        const Node& node = nodes[index];
+        work.pop_back();
+
+        if (node.left < 0)
+            infix += node.token;
+        else if (phase == 0) {
+            infix += '(';
+            work.push_back(std::make_pair(index, 1));
+            work.push_back(std::make_pair(node.left, 0));
+        }
+        else if (phase == 1) {
+            infix += ' ';
+            infix += node.token;
+            infix += ' ';
+            work.push_back(std::make_pair(index, 2));
+            work.push_back(std::make_pair(node.right, 0));
+        }
+        else
+            infix += ')';
+    }
+    return infix;
+}
+
+// Breaks a valid subject expression in one of several ways, each with a
+// known first error
+RPNGenerator::Case RPNGenerator::corrupt(const Case& valid) {
+    Case result = valid;
+    size_t position;
+
+    result.valid = false;
+    result.infix.clear();
+    switch (below(5)) {
+        case 0:
+        case 1:
+            // An unknown token somewhere between existing tokens
+            position = result.rpn.find(' ', below(result.rpn.size() + 1));
+            if (position == std::string::npos)
+                position = result.rpn.size();
+            result.rpn.insert(position, below(2) ? " (" : " 12");
+            result.error = "Invalid input token";
+            break;
+        case 2:
+            // Leftover operand
+            result.rpn += " 7";
+            result.error = "Invalid expression";
+            break;
+        case 3:
+            // Operator with nothing to work on
+            result.rpn.insert(0, "+ ");
+            result.error = "Invalid expression";
+            break;
+        default:
+            result.rpn += " 0 /";
+            result.error = "Division by zero";
+    }
+    return result;
+}
+
+const int* RPNGenerator::getVariables() const {
+    return variables;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef RPNGENERATOR_HPP
+#define RPNGENERATOR_HPP
+
+#include <string>
+#include <vector>
+
+// Random expression generator for benchmarks. Every expression is built
+// as a tree, so the expected result comes from a reference evaluation of
+// that tree rather than from the RPN code under test.
+class RPNGenerator
+{
+public:
+    struct Shape {
+        const char* name;
+        size_t operands;     // operand tokens in the expression
+        size_t maxDepth;     // the stack never grows deeper than this
+        int pushPercent;     // chance of an operand when an operator also fits
+        int weights[4];      // relative frequency of + - * /
+        bool variables;      // half of the operands are the variables a-z
+        int extended;        // 1 adds % neg min max dup swap, 2 also ^ sqrt
+    };
+
+    struct Case {
+        std::string rpn;
+        std::string infix;
+        size_t tokens;
+        bool valid;
+        int expected;        // result when valid
+        double expectedReal; // evaluateReal() result of an extended case
+        std::string error;   // what() of the expected exception otherwise
+    };
+
+private:
+    struct Node {
+        char token;
+        int left;
+        int right;
+    };
+
+    unsigned long state;
+    int variables[26];
+
+    unsigned long next();
+    size_t below(size_t bound);
+    static int apply(char operation, int operand1, int operand2);
+    static int applyExtended(const std::string& operation, int operand1, int operand2);
+    static double applyReal(const std::string& operation, double operand1, double operand2);
+    Case generateExtended(const Shape& shape);
+    static std::string toInfix(const std::vector<Node>& nodes);
+
+public:
+    explicit RPNGenerator(unsigned long seed = 42);
+    ~RPNGenerator();
+    RPNGenerator(const RPNGenerator& other);
+    RPNGenerator& operator=(const RPNGenerator& other);
+
+    Case generate(const Shape& shape);
+    Case corrupt(const Case& valid);
+    const int* getVariables() const;
+};
+
+#endif
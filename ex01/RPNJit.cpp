@@ -0,0 +1,161 @@
+#include "RPNJit.hpp"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+# define RPN_JIT_NATIVE 1
+# include <sys/mman.h>
+# include <unistd.h>
+#else
+# define RPN_JIT_NATIVE 0
+#endif
+
+// Programs deeper than this would use too much of the machine stack
+static const size_t MAX_NATIVE_DEPTH = 1 << 16;
+
+// Compiles the program right away; failure leaves the interpreter in charge
+RPNJit::RPNJit(const RPN::Program& program)
+    : program(program), registers(program.registers, 0),
+      page(0), pageSize(0), function(0) {
+    compile();
+}
+
+// Destructor - releases the executable page
+RPNJit::~RPNJit() {
+#if RPN_JIT_NATIVE
+    if (page)
+        munmap(page, pageSize);
+#endif
+}
+
+bool RPNJit::isNative() const {
+    return function != 0;
+}
+
+#if RPN_JIT_NATIVE
+
+static void emit(std::vector<unsigned char>& code, const char* bytes, size_t length) {
+    code.insert(code.end(), bytes, bytes + length);
+}
+
+static void emitInt32(std::vector<unsigned char>& code, int value) {
+    for (int i = 0; i < 4; i++)
+        code.push_back(static_cast<unsigned char>(static_cast<unsigned int>(value) >> (8 * i)));
+}
+
+// Generated code follows the System V ABI: registers in rdi, fault flag
+// pointer in rsi, result in eax. Operands live on the machine stack, and
+// rsp is saved in r9 so a division by zero can unwind in one move.
+void RPNJit::compile() {
+    std::vector<unsigned char> code;
+    std::vector<size_t> faultJumps;
+    size_t depth = 0;
+    size_t maxDepth = 0;
+
+    emit(code, "\x49\x89\xe1", 3);                      // mov r9, rsp
+    std::vector<RPN::Instruction>::const_iterator it = program.code.begin();
+    for (; it != program.code.end(); it++) {
+        int displacement = it->operand * 4;
+        switch (it->op) {
+            case RPN::PUSH:
+                emit(code, "\x68", 1);                  // push imm32
+                emitInt32(code, it->operand);
+                depth++;
+                break;
+            case RPN::LOAD:
+                emit(code, "\x8b\x87", 2);              // mov eax, [rdi + disp32]
+                emitInt32(code, displacement);
+                emit(code, "\x50", 1);                  // push rax
+                depth++;
+                break;
+            case RPN::STORE:
+                if (depth < 1)
+                    return;
+                emit(code, "\x8b\x04\x24", 3);          // mov eax, [rsp]
+                emit(code, "\x89\x87", 2);              // mov [rdi + disp32], eax
+                emitInt32(code, displacement);
+                break;
+            case RPN::NEG:
+                if (depth < 1)
+                    return;
+                emit(code, "\xf7\x1c\x24", 3);          // neg dword [rsp]
+                break;
+            default:
+                if (depth < 2)
+                    return;
+                emit(code, "\x59\x58", 2);              // pop rcx; pop rax
+                if (it->op == RPN::ADD)
+                    emit(code, "\x01\xc8", 2);          // add eax, ecx
+                else if (it->op == RPN::SUB)
+                    emit(code, "\x29\xc8", 2);          // sub eax, ecx
+                else if (it->op == RPN::MUL)
+                    emit(code, "\x0f\xaf\xc1", 3);      // imul eax, ecx
+                else if (it->op == RPN::DIV) {
+                    emit(code, "\x85\xc9", 2);          // test ecx, ecx
+                    emit(code, "\x0f\x84", 2);          // jz fault
+                    faultJumps.push_back(code.size());
+                    emitInt32(code, 0);
+                    emit(code, "\x99\xf7\xf9", 3);      // cdq; idiv ecx
+                }
+                else
+                    return;
+                emit(code, "\x50", 1);                  // push rax
+                depth--;
+        }
+        if (depth > maxDepth)
+            maxDepth = depth;
+    }
+    // Malformed programs keep the interpreter so errors match RPN::execute
+    if (depth != 1 || maxDepth > MAX_NATIVE_DEPTH)
+        return;
+    emit(code, "\x58\xc3", 2);                          // pop rax; ret
+
+    size_t fault = code.size();
+    for (size_t i = 0; i < faultJumps.size(); i++) {
+        int offset = static_cast<int>(fault - (faultJumps[i] + 4));
+        for (int b = 0; b < 4; b++)
+            code[faultJumps[i] + b] = static_cast<unsigned char>(
+                static_cast<unsigned int>(offset) >> (8 * b));
+    }
+    emit(code, "\xc7\x06\x01\x00\x00\x00", 6);          // mov dword [rsi], 1
+    emit(code, "\x4c\x89\xcc", 3);                      // mov rsp, r9
+    emit(code, "\x31\xc0\xc3", 3);                      // xor eax, eax; ret
+
+    // Map writable, copy, then flip to executable
+    size_t granule = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    pageSize = (code.size() + granule - 1) / granule * granule;
+    page = mmap(0, pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (page == MAP_FAILED) {
+        page = 0;
+        return;
+    }
+    std::copy(code.begin(), code.end(), static_cast<unsigned char*>(page));
+    if (mprotect(page, pageSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(page, pageSize);
+        page = 0;
+        return;
+    }
+    function = reinterpret_cast<NativeFunction>(page);
+}
+
+#else
+
+void RPNJit::compile() {}
+
+#endif
+
+int RPNJit::run(const int* variables) {
+    if (!function)
+        return interpreter.execute(program, variables);
+
+    // Same register layout as RPN::execute: variables first, then temporaries
+    std::fill(registers.begin(), registers.end(), 0);
+    if (variables)
+        for (int i = 0; i < RPN::VARIABLES && i < program.registers; i++)
+            registers[i] = variables[i];
+
+    int fault = 0;
+    int result = function(registers.empty() ? 0 : &registers[0], &fault);
+    if (fault)
+        throw std::runtime_error("Division by zero");
+    return result;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#ifndef RPNJIT_HPP
+#define RPNJIT_HPP
+
+#include "RPN.hpp"
+
+// Compiles an RPN::Program to native x86-64 code in an executable page.
+// On other targets, or when a program cannot be compiled, run() falls
+// back to RPN::execute with identical results and errors.
+class RPNJit
+{
+private:
+    typedef int (*NativeFunction)(int* registers, int* fault);
+
+    RPN::Program program;
+    RPN interpreter;
+    std::vector<int> registers;
+    void* page;
+    size_t pageSize;
+    NativeFunction function;
+
+    void compile();
+
+    // Owns executable memory, so copies are not allowed
+    RPNJit(const RPNJit& other);
+    RPNJit& operator=(const RPNJit& other);
+
+public:
+    explicit RPNJit(const RPN::Program& program);
+    ~RPNJit();
+
+    int run(const int* variables = 0);
+    bool isNative() const;
+};
+
+#endif
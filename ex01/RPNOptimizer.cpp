@@ -0,0 +1,230 @@
+#include "RPNOptimizer.hpp"
+
+// Default constructor - no expression optimized yet
+RPNOptimizer::RPNOptimizer() : tokenCount(0), nodeCount(0), simplify(true) {}
+
+// Copy constructor - copies the last DAG and its statistics
+RPNOptimizer::RPNOptimizer(const RPNOptimizer& other) {
+    *this = other;
+}
+
+// Assignment operator - copies the last DAG and its statistics
+RPNOptimizer& RPNOptimizer::operator=(const RPNOptimizer& other) {
+    if (this != &other) {
+        this->nodes = other.nodes;
+        this->index = other.index;
+        this->tokenCount = other.tokenCount;
+        this->nodeCount = other.nodeCount;
+        this->simplify = other.simplify;
+    }
+    return *this;
+}
+
+// Destructor - containers clean up after themselves
+RPNOptimizer::~RPNOptimizer() {}
+
+// Structural ordering used to find identical subexpressions
+bool RPNOptimizer::Node::operator<(const Node& other) const {
+    if (op != other.op) return op < other.op;
+    if (operand != other.operand) return operand < other.operand;
+    if (left != other.left) return left < other.left;
+    return right < other.right;
+}
+
+// Returns the existing node with the same shape, or creates it
+int RPNOptimizer::intern(RPN::Opcode op, int operand, int left, int right) {
+    Node node;
+    node.op = op;
+    node.operand = operand;
+    node.left = left;
+    node.right = right;
+    node.mayFault = false;
+    if (op >= RPN::ADD) {
+        node.mayFault = nodes[left].mayFault || nodes[right].mayFault;
+        if (op == RPN::DIV && !(nodes[right].op == RPN::PUSH && nodes[right].operand != 0))
+            node.mayFault = true;
+    }
+
+    if (!simplify) {
+        nodes.push_back(node);
+        return nodes.size() - 1;
+    }
+    std::map<Node, int>::iterator found = index.find(node);
+    if (found != index.end())
+        return found->second;
+    nodes.push_back(node);
+    index[node] = nodes.size() - 1;
+    return nodes.size() - 1;
+}
+
+bool RPNOptimizer::isConstant(int node, int value) const {
+    return nodes[node].op == RPN::PUSH && nodes[node].operand == value;
+}
+
+// Builds "left op right", folding constants and applying identities.
+// Rewrites that would drop a subtree are only done when that subtree
+// cannot fault, so a division by zero still surfaces at run time.
+int RPNOptimizer::combine(RPN::Opcode op, int left, int right) {
+    const Node& l = nodes[left];
+    const Node& r = nodes[right];
+
+    if (!simplify)
+        return intern(op, 0, left, right);
+    if (l.op == RPN::PUSH && r.op == RPN::PUSH && !(op == RPN::DIV && r.operand == 0)) {
+        int value = 0;
+        switch (op) {
+            case RPN::ADD: value = l.operand + r.operand; break;
+            case RPN::SUB: value = l.operand - r.operand; break;
+            case RPN::MUL: value = l.operand * r.operand; break;
+            default:       value = l.operand / r.operand; break;
+        }
+        return intern(RPN::PUSH, value, -1, -1);
+    }
+
+    switch (op) {
+        case RPN::ADD:
+            if (isConstant(right, 0)) return left;
+            if (isConstant(left, 0)) return right;
+            break;
+        case RPN::SUB:
+            if (isConstant(right, 0)) return left;
+            if (left == right && !l.mayFault) return intern(RPN::PUSH, 0, -1, -1);
+            break;
+        case RPN::MUL:
+            if (isConstant(right, 1)) return left;
+            if (isConstant(left, 1)) return right;
+            if ((isConstant(right, 0) && !l.mayFault) || (isConstant(left, 0) && !r.mayFault))
+                return intern(RPN::PUSH, 0, -1, -1);
+            break;
+        case RPN::DIV:
+            if (isConstant(right, 1)) return left;
+            break;
+        default:
+            break;
+    }
+
+    // Canonical operand order lets "a b +" and "b a +" share one node
+    if ((op == RPN::ADD || op == RPN::MUL) && right < left)
+        std::swap(left, right);
+    return intern(op, 0, left, right);
+}
+
+// Emits the DAG reachable from root in post-order. Interior nodes used
+// more than once are computed once, kept in a temporary register and
+// reloaded afterwards.
+void RPNOptimizer::emit(int root, RPN::Program& program) {
+    std::vector<int> uses(nodes.size(), 0);
+    std::vector<int> slots(nodes.size(), -1);
+    std::vector<bool> reachable(nodes.size(), false);
+
+    // Children always precede their parents, so one backward sweep counts uses
+    reachable[root] = true;
+    nodeCount = 0;
+    for (int i = root; i >= 0; i--) {
+        if (!reachable[i])
+            continue;
+        nodeCount++;
+        if (nodes[i].op >= RPN::ADD) {
+            uses[nodes[i].left]++;
+            uses[nodes[i].right]++;
+            reachable[nodes[i].left] = true;
+            reachable[nodes[i].right] = true;
+        }
+    }
+
+    program.code.clear();
+    program.registers = RPN::VARIABLES;
+    std::vector< std::pair<int, bool> > work;
+    work.push_back(std::make_pair(root, false));
+    while (!work.empty()) {
+        int current = work.back().first;
+        bool expanded = work.back().second;
+        work.pop_back();
+
+        const Node& node = nodes[current];
+        RPN::Instruction instruction;
+        if (slots[current] >= 0) {
+            instruction.op = RPN::LOAD;
+            instruction.operand = slots[current];
+        }
+        else if (node.op < RPN::ADD) {
+            instruction.op = node.op;
+            instruction.operand = node.operand;
+        }
+        else if (!expanded) {
+            work.push_back(std::make_pair(current, true));
+            work.push_back(std::make_pair(node.right, false));
+            work.push_back(std::make_pair(node.left, false));
+            continue;
+        }
+        else {
+            instruction.op = node.op;
+            instruction.operand = 0;
+            if (uses[current] > 1) {
+                program.code.push_back(instruction);
+                slots[current] = program.registers++;
+                instruction.op = RPN::STORE;
+                instruction.operand = slots[current];
+            }
+        }
+        program.code.push_back(instruction);
+    }
+}
+
+RPN::Program RPNOptimizer::optimize(const std::string& expression) {
+    std::istringstream iss(expression);
+    std::string token;
+    std::vector<int> operands;
+
+    nodes.clear();
+    index.clear();
+    tokenCount = 0;
+
+    while (iss >> token) {
+        tokenCount++;
+        char c = token[0];
+
+        // Case 1: single digit constant or single letter variable
+        if (token.length() == 1 && isdigit(c))
+            operands.push_back(intern(RPN::PUSH, c - '0', -1, -1));
+        else if (token.length() == 1 && c >= 'a' && c <= 'z')
+            operands.push_back(intern(RPN::LOAD, c - 'a', -1, -1));
+
+        // Case 2: operator
+        else if (token.length() == 1 && (c == '+' || c == '-' || c == '*' || c == '/')) {
+            if (operands.size() < 2)
+                throw std::runtime_error("Invalid expression");
+            int right = operands.back(); operands.pop_back();
+            int left = operands.back(); operands.pop_back();
+            RPN::Opcode op = c == '+' ? RPN::ADD : c == '-' ? RPN::SUB
+                           : c == '*' ? RPN::MUL : RPN::DIV;
+            operands.push_back(combine(op, left, right));
+        }
+
+        // Case 3: invalid token
+        else
+            throw std::runtime_error("Invalid input token");
+    }
+
+    if (operands.size() != 1)
+        throw std::runtime_error("Invalid expression");
+
+    RPN::Program program;
+    emit(operands.back(), program);
+    program.depth = RPN::measureDepth(program);
+    return program;
+}
+
+void RPNOptimizer::setSimplify(bool enabled) {
+    simplify = enabled;
+}
+
+// Number of tokens in the last optimized expression
+size_t RPNOptimizer::getTokenCount() const {
+    return tokenCount;
+}
+
+// Number of DAG nodes left after optimization
+size_t RPNOptimizer::getNodeCount() const {
+    return nodeCount;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef RPNOPTIMIZER_HPP
+#define RPNOPTIMIZER_HPP
+
+#include "RPN.hpp"
+#include <map>
+
+// Turns an RPN expression into an expression DAG, simplifies it and
+// re-emits it as an RPN::Program. Single lowercase letters are variables
+// whose values are supplied when the program is executed.
+class RPNOptimizer
+{
+private:
+    struct Node {
+        RPN::Opcode op;
+        int operand;    // constant value (PUSH) or register (LOAD)
+        int left;
+        int right;
+        bool mayFault;  // evaluating the subtree can divide by zero
+
+        bool operator<(const Node& other) const;
+    };
+
+    std::vector<Node> nodes;
+    std::map<Node, int> index;
+    size_t tokenCount;
+    size_t nodeCount;
+    bool simplify;
+
+    int intern(RPN::Opcode op, int operand, int left, int right);
+    int combine(RPN::Opcode op, int left, int right);
+    bool isConstant(int node, int value) const;
+    void emit(int root, RPN::Program& program);
+
+public:
+    RPNOptimizer();
+    ~RPNOptimizer();
+    RPNOptimizer(const RPNOptimizer& other);
+    RPNOptimizer& operator=(const RPNOptimizer& other);
+
+    RPN::Program optimize(const std::string& expression);
+
+    // With simplify off, optimize() neither folds nor shares nodes and
+    // emits one instruction per token: the program as written, which the
+    // optimized one is measured against
+    void setSimplify(bool enabled);
+    size_t getTokenCount() const;
+    size_t getNodeCount() const;
+};
+
+#endif
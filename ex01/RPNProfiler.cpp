@@ -0,0 +1,84 @@
+#include "RPNProfiler.hpp"
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+
+// Default constructor - zeroed counters and an empty trace
+RPNProfiler::RPNProfiler()
+    : maxDepth(0), evaluations(0), totalNanoseconds(0), startNanoseconds(0), steps(0),
+      ring(new unsigned char[TRACE_CAPACITY * RECORD_SIZE]) {
+    std::fill(counts, counts + OPCODES, 0);
+}
+
+// Copy constructor - copies counters and the trace
+RPNProfiler::RPNProfiler(const RPNProfiler& other)
+    : ring(new unsigned char[TRACE_CAPACITY * RECORD_SIZE]) {
+    *this = other;
+}
+
+// Assignment operator - copies counters and the trace
+RPNProfiler& RPNProfiler::operator=(const RPNProfiler& other) {
+    if (this != &other) {
+        std::copy(other.counts, other.counts + OPCODES, counts);
+        maxDepth = other.maxDepth;
+        evaluations = other.evaluations;
+        totalNanoseconds = other.totalNanoseconds;
+        startNanoseconds = other.startNanoseconds;
+        steps = other.steps;
+        std::copy(other.ring, other.ring + TRACE_CAPACITY * RECORD_SIZE, ring);
+    }
+    return *this;
+}
+
+// Destructor - releases the trace buffer
+RPNProfiler::~RPNProfiler() {
+    delete [] ring;
+}
+
+unsigned long long RPNProfiler::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+void RPNProfiler::begin() {
+    startNanoseconds = now();
+}
+
+void RPNProfiler::end() {
+    totalNanoseconds += now() - startNanoseconds;
+    evaluations++;
+}
+
+// Names indexed by RPN::Opcode
+const char* RPNProfiler::opcodeName(int opcode) {
+    static const char* names[] = {
+        "push", "load", "store", "+", "-", "*", "/", "neg",
+        "%", "^", "min", "max", "sqrt", "dup", "swap"
+    };
+    if (opcode < 0 || opcode >= static_cast<int>(sizeof(names) / sizeof(names[0])))
+        return "?";
+    return names[opcode];
+}
+
+void RPNProfiler::report(std::ostream& out) const {
+    out << "evaluations: " << evaluations << std::endl;
+    out << "total time:  " << totalNanoseconds / 1000.0 << " us" << std::endl;
+    out << "max depth:   " << maxDepth << std::endl;
+    for (unsigned int op = 0; op < OPCODES; op++)
+        if (counts[op])
+            out << std::setw(13) << std::left << opcodeName(op) << counts[op] << std::endl;
+}
+
+// Trace file: "RPNT", the total step count as 8 little-endian bytes,
+// then the retained records from oldest to newest
+void RPNProfiler::writeTrace(std::ostream& out) const {
+    unsigned long long kept = std::min<unsigned long long>(steps, TRACE_CAPACITY);
+    unsigned char header[12] = {'R', 'P', 'N', 'T'};
+    for (int i = 0; i < 8; i++)
+        header[4 + i] = static_cast<unsigned char>(steps >> (8 * i));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (unsigned long long i = steps - kept; i < steps; i++)
+        out.write(reinterpret_cast<const char*>(ring + (i & (TRACE_CAPACITY - 1)) * RECORD_SIZE),
+                  RECORD_SIZE);
+}
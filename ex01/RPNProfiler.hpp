@@ -0,0 +1,60 @@
+#pragma once
+#ifndef RPNPROFILER_HPP
+#define RPNPROFILER_HPP
+
+// Build with -DRPN_PROFILE=1 to instrument RPN::evaluate; make profile
+// does so as RPN_profile. When it is 0 the hooks expand to nothing and
+// RPN has no profiler member.
+#ifndef RPN_PROFILE
+# define RPN_PROFILE 0
+#endif
+
+#include <ostream>
+#include <string>
+
+// Per-opcode token counts, maximum stack depth, total evaluation time
+// and a ring buffer holding the most recent steps in a compact binary form
+class RPNProfiler
+{
+public:
+    static const unsigned int OPCODES = 16;
+    static const unsigned int TRACE_CAPACITY = 1 << 16;  // power of two
+    static const unsigned int RECORD_SIZE = 9;           // op, value, depth
+
+private:
+    unsigned long counts[OPCODES];
+    unsigned long maxDepth;
+    unsigned long evaluations;
+    unsigned long long totalNanoseconds;
+    unsigned long long startNanoseconds;
+    unsigned long long steps;
+    unsigned char* ring;
+
+    static unsigned long long now();
+
+public:
+    RPNProfiler();
+    ~RPNProfiler();
+    RPNProfiler(const RPNProfiler& other);
+    RPNProfiler& operator=(const RPNProfiler& other);
+
+    void begin();
+    void end();
+    void record(int opcode, int value, unsigned long depth) {
+        counts[opcode]++;
+        if (depth > maxDepth)
+            maxDepth = depth;
+        unsigned char* slot = ring + (steps++ & (TRACE_CAPACITY - 1)) * RECORD_SIZE;
+        slot[0] = static_cast<unsigned char>(opcode);
+        for (int i = 0; i < 4; i++) {
+            slot[1 + i] = static_cast<unsigned char>(static_cast<unsigned int>(value) >> (8 * i));
+            slot[5 + i] = static_cast<unsigned char>(depth >> (8 * i));
+        }
+    }
+
+    void report(std::ostream& out) const;
+    void writeTrace(std::ostream& out) const;
+    static const char* opcodeName(int opcode);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "RPNProfiler.hpp"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Decodes a trace written by RPNProfiler::writeTrace
+int main(int ac, char** av) {
+    if (ac != 2) {
+        std::cout << "Usage: ./rpn_trace rpn.trace" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(av[1], std::ios::binary);
+    unsigned char header[12];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))
+        || header[0] != 'R' || header[1] != 'P' || header[2] != 'N' || header[3] != 'T') {
+        std::cerr << "Error: " << av[1] << " is not an RPN trace" << std::endl;
+        return 1;
+    }
+
+    unsigned long long steps = 0;
+    for (int i = 7; i >= 0; i--)
+        steps = (steps << 8) | header[4 + i];
+
+    std::vector<unsigned char> record(RPNProfiler::RECORD_SIZE);
+    std::vector< std::vector<unsigned char> > records;
+    while (in.read(reinterpret_cast<char*>(&record[0]), record.size()))
+        records.push_back(record);
+
+    std::cout << std::setw(12) << std::left << "step" << std::setw(8) << "op"
+              << std::setw(14) << "top" << "depth" << std::endl;
+    unsigned long long first = steps - records.size();
+    for (size_t i = 0; i < records.size(); i++) {
+        unsigned int value = 0;
+        unsigned int depth = 0;
+        for (int b = 3; b >= 0; b--) {
+            value = (value << 8) | records[i][1 + b];
+            depth = (depth << 8) | records[i][5 + b];
+        }
+        std::cout << std::setw(12) << first + i << std::setw(8)
+                  << RPNProfiler::opcodeName(records[i][0])
+                  << std::setw(14) << static_cast<int>(value) << depth << std::endl;
+    }
+    return 0;
+}
@@ -1,15 +1,40 @@
 #include "RPN.hpp"
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
 
 int main(int ac, char** av) {
-    if (ac != 2) {
+    bool fromFile = ac == 3 && std::string(av[1]) == "--file";
+    if (ac != 2 && !fromFile) {
         std::cout << "Usage: ./RPN \"expression\"" << std::endl;
+        std::cout << "       ./RPN --file path" << std::endl;
         return 1;
     }
 
     RPN rpn;
     try {
-        int result = rpn.evaluate(av[1]);
+        int result;
+        if (fromFile) {
+            int fd = open(av[2], O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error(std::string("Cannot open ") + av[2]);
+            try {
+                result = rpn.evaluateStream(fd);
+            }
+            catch (...) {
+                close(fd);
+                throw;
+            }
+            close(fd);
+        }
+        else
+            result = rpn.evaluate(av[1]);
         std::cout << result << std::endl;
+#if RPN_PROFILE
+        rpn.getProfiler().report(std::cerr);
+        std::ofstream trace("rpn.trace", std::ios::binary);
+        rpn.getProfiler().writeTrace(trace);
+#endif
     } 
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -0,0 +1,195 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Times PmergeMe on each backend against std::sort and
+ *        std::stable_sort over several input distributions. Every sorter
+ *        runs warmup untimed trials, then timed trials on fresh copies of
+ *        the same input; only sort() itself is timed, on the wall clock
+ *        and the process CPU clock. Inputs come from a fixed seed, so
+ *        results from different builds are comparable.
+ */
+class Benchmark
+{
+	public:
+		enum Distribution
+		{
+			RANDOM,
+			SORTED,
+			REVERSED,
+			FEW_UNIQUE,
+			SAWTOOTH,
+			NEARLY_SORTED,
+			SWAPPED,
+			SORTED_TAIL,
+			DISTRIBUTIONS
+		};
+
+		Benchmark( void );
+
+		/**
+		 * @param elements Input size
+		 * @param trials Timed trials per sorter and distribution
+		 * @param warmup Untimed trials run first
+		 * @param threads Threads PmergeMe may use
+		 */
+		Benchmark( size_t elements, int trials, int warmup, int threads );
+		Benchmark( const Benchmark & src );
+		~Benchmark( void );
+
+		/**
+		 * @brief Assignment operator
+		 * @param src Source object to assign from
+		 * @return Reference to this object
+		 */
+		Benchmark & operator=( const Benchmark & src );
+
+		/**
+		 * @brief Runs every sorter on every distribution, then times
+		 *        record sorts against std::sort and std::stable_sort,
+		 *        each pair-formation kernel the CPU supports, the list
+		 *        path with its node arena against the global heap, and
+		 *        insertion schedule generation alone, and PmergeMe vector
+		 *        with and without its adaptive path on presorted input.
+		 *        With more than one
+		 *        thread, also sorts the random input with PmergeMe vector
+		 *        on 1 up to threads threads. After setExternal(), also
+		 *        times ExternalSort.
+		 * @throws std::runtime_error if a sorter or kernel returns a wrong
+		 *         result, or a thread count changes the number of
+		 *         comparisons
+		 */
+		void run( void );
+
+		/**
+		 * @brief Adds external rows to run(): a random input of times x
+		 *        budget bytes, written to directory, sorted by
+		 *        ExternalSort within budget and again within
+		 *        SMALL_BUDGET, where there are more runs than one merge
+		 *        can take, each output checked against std::sort
+		 * @param budget Memory budget in bytes, 0 for no external rows
+		 * @param times Input size as a multiple of budget
+		 * @param directory Where the input, output and runs go
+		 */
+		void setExternal( size_t budget, int times, const std::string & directory );
+
+		/**
+		 * @brief Writes one row per sorter and distribution: wall-clock
+		 *        median, 10th and 90th percentiles, CPU median, comparisons
+		 *        and heap allocations per sort, plus the arena's node
+		 *        requests and slab size where a sort used it
+		 */
+		void print( std::ostream & os ) const;
+
+		/**
+		 * @brief Writes the settings, percentiles and raw samples as JSON
+		 */
+		void writeJson( std::ostream & os ) const;
+
+		/**
+		 * @brief Builds an input of the given distribution, the same for a
+		 *        given seed on every platform. NEARLY_SORTED and SWAPPED
+		 *        are sorted input with one random pair swapped per 1000
+		 *        and per 100 elements; SORTED_TAIL is sorted but for a
+		 *        random last hundredth.
+		 */
+		static std::vector<int> generate( Distribution distribution, size_t elements,
+		                                  unsigned int seed );
+		static const char * getName( Distribution distribution );
+
+	private:
+		struct Result
+		{
+			std::string distribution;
+			std::string sorter;
+			// Milliseconds per timed trial, in run order
+			std::vector<double> wall;
+			std::vector<double> cpu;
+			unsigned long comparisons;
+			// Heap allocations made by one sort
+			unsigned long allocations;
+			// Node requests served by the sorter's arena, and its slab bytes
+			size_t arenaAllocations;
+			size_t arenaBytes;
+			// Runs and merge passes of an external sort
+			size_t runs;
+			size_t passes;
+
+			Result( const std::string & input, const std::string & name )
+				: distribution( input ), sorter( name ), comparisons( 0 ), allocations( 0 ),
+				  arenaAllocations( 0 ), arenaBytes( 0 ), runs( 0 ), passes( 0 ) {}
+		};
+
+		// 64 bytes: a key, then a payload every sort has to move with it
+		struct Record
+		{
+			int64_t key;
+			int payload[14];
+		};
+
+		enum RecordSorter
+		{
+			PMERGEME,
+			STD_SORT,
+			STD_STABLE_SORT
+		};
+
+		// Seed of every generated input
+		static const unsigned int SEED = 42;
+		// Second external budget; its merge takes 3 runs at once
+		static const size_t SMALL_BUDGET = 1 << 18;
+
+		size_t _elements;
+		int _trials;
+		int _warmup;
+		int _threads;
+		size_t _externalBudget;
+		int _externalTimes;
+		std::string _directory;
+		std::vector<Result> _results;
+
+		template <typename Container>
+		void _measurePmergeMe( const std::vector<int> & input, const std::vector<int> & expected,
+		                       int threads, bool nodeArena, bool adaptive,
+		                       Result & result ) const;
+		void _measureStd( const std::vector<int> & input, const std::vector<int> & expected,
+		                  bool stable, Result & result ) const;
+		void _measureSchedule( Result & result ) const;
+		void _runScaling( void );
+		void _runKernels( void );
+		void _runAllocators( void );
+		void _runAdaptive( void );
+		void _runRecords( void );
+		void _runExternal( void );
+		void _measureExternal( const std::string & input, const std::string & output,
+		                       const std::vector<int> & expected, size_t budget,
+		                       Result & result ) const;
+
+		/**
+		 * @param byKey Sorts by the plain key, through sortByKey() for
+		 *        PMERGEME, instead of the costly record ordering
+		 */
+		void _measureRecords( const std::vector<Record> & input,
+		                      const std::vector<Record> & expected, RecordSorter sorter,
+		                      bool byKey, Result & result ) const;
+
+		/**
+		 * @brief Number of operator new calls since the program started,
+		 *        counted by the replacement in Benchmark.cpp; always 0 outside
+		 *        the make bench build
+		 */
+		static unsigned long _allocations( void );
+		static double _percentile( std::vector<double> samples, double fraction );
+		static void _writeStatistics( std::ostream & os, const std::vector<double> & samples );
+		static void _writeSamples( std::ostream & os, const std::vector<double> & samples );
+};
+
+#include "Benchmark.tpp"
+
+#endif
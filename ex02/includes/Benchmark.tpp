@@ -0,0 +1,47 @@
+#ifndef BENCHMARK_TPP
+#define BENCHMARK_TPP
+
+#include "PmergeMe.hpp"
+#include "Stopwatch.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+// Copies the input into a new sorter before every trial, outside the timing
+template <typename Container>
+void Benchmark::_measurePmergeMe( const std::vector<int> & input,
+                                  const std::vector<int> & expected, int threads,
+                                  bool nodeArena, bool adaptive, Result & result ) const
+{
+	Stopwatch stopwatch;
+	for ( int trial = 0; trial < _warmup + _trials; trial++ )
+	{
+		PmergeMe<Container> sorter( input.begin(), input.end() );
+		sorter.setThreads( threads );
+		sorter.setNodeArena( nodeArena );
+		sorter.setAdaptive( adaptive );
+		unsigned long allocations = _allocations();
+		stopwatch.start();
+		sorter.sort();
+		stopwatch.stop();
+		if ( trial == 0 )
+		{
+			const Container & sorted = sorter.getSequence();
+			if ( !std::equal( sorted.begin(), sorted.end(), expected.begin() ) )
+			{
+				throw ( std::runtime_error( result.sorter + " sorted " + result.distribution +
+				                            " input incorrectly" ) );
+			}
+			result.comparisons = sorter.getComparisons();
+			result.allocations = _allocations() - allocations;
+			result.arenaAllocations = sorter.getArena().getAllocations();
+			result.arenaBytes = sorter.getArena().getReservedBytes();
+		}
+		if ( trial >= _warmup )
+		{
+			result.wall.push_back( stopwatch.getWall() );
+			result.cpu.push_back( stopwatch.getCpu() );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef BLOCKED_CHAIN_HPP
+#define BLOCKED_CHAIN_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Sequence of cache-sized blocks for the merge-insertion main chain.
+ *        Rank lookup and insertion go through a Fenwick tree over the block
+ *        sizes, so an insertion costs O(log n) to find its block plus at
+ *        most one block's worth of moves, instead of shifting the whole
+ *        chain like std::vector::insert. A block that fills up splits, which
+ *        shifts the block pointers behind it and recomputes their Fenwick
+ *        nodes, O(n / BLOCK_SIZE); it takes BLOCK_SIZE / 2 insertions to
+ *        fill a block again, so this adds O(n / BLOCK_SIZE^2) per insertion
+ *        on average, under one step per insertion below 100000 elements.
+ */
+template <typename T>
+class BlockedChain
+{
+	private:
+		// Blocks are filled to half on push_back and split past the maximum
+		static const size_t BLOCK_SIZE = 512;
+
+		std::vector< std::vector<T> * > _blocks;
+		std::vector<int> _tree;
+		size_t _size;
+
+		void _locate( size_t rank, size_t & block, size_t & offset ) const;
+		void _grow( size_t block );
+		void _rebuildTree( size_t first );
+		void _clear( void );
+
+	public:
+		BlockedChain( void );
+		BlockedChain( const BlockedChain & src );
+		~BlockedChain( void );
+
+		/**
+		 * @brief Assignment operator
+		 * @param src Source object to assign from
+		 * @return Reference to this object
+		 */
+		BlockedChain & operator=( const BlockedChain & src );
+
+		size_t size( void ) const;
+
+		/**
+		 * @brief Appends while building the initial chain
+		 */
+		void push_back( const T & value );
+
+		/**
+		 * @brief Element at rank, O(log n)
+		 */
+		const T & operator[]( size_t rank ) const;
+
+		/**
+		 * @brief Block holding rank
+		 * @param first Receives the rank of the block's first element
+		 * @param length Receives the number of elements in the block
+		 * @return The block's contiguous elements
+		 */
+		const T * block( size_t rank, size_t & first, size_t & length ) const;
+
+		/**
+		 * @brief Inserts value so that it ends up at rank
+		 */
+		void insert( size_t rank, const T & value );
+
+		/**
+		 * @brief Appends every element, in order, to a contiguous sequence
+		 * @param out Sequence receiving the elements
+		 */
+		template <typename Sequence>
+		void flatten( Sequence & out ) const;
+};
+
+#include "BlockedChain.tpp"
+
+#endif
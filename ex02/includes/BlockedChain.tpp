@@ -0,0 +1,209 @@
+#ifndef BLOCKED_CHAIN_TPP
+#define BLOCKED_CHAIN_TPP
+
+// Default constructor
+template <typename T>
+BlockedChain<T>::BlockedChain( void ) : _tree( 1, 0 ), _size( 0 ) {}
+
+// Copy constructor
+template <typename T>
+BlockedChain<T>::BlockedChain( const BlockedChain & src ) : _tree( 1, 0 ), _size( 0 )
+{
+	*this = src;
+}
+
+// Destructor
+template <typename T>
+BlockedChain<T>::~BlockedChain( void )
+{
+	_clear();
+}
+
+// Assignment operator
+template <typename T>
+BlockedChain<T> & BlockedChain<T>::operator=( const BlockedChain & src )
+{
+	if ( this != &src )
+	{
+		_clear();
+		for ( size_t i = 0; i < src._blocks.size(); i++ )
+		{
+			_blocks.push_back( new std::vector<T>( *src._blocks[i] ) );
+		}
+		_tree = src._tree;
+		_size = src._size;
+	}
+	return ( *this );
+}
+
+template <typename T>
+size_t BlockedChain<T>::size( void ) const
+{
+	return ( _size );
+}
+
+template <typename T>
+void BlockedChain<T>::push_back( const T & value )
+{
+	if ( _blocks.empty() || _blocks.back()->size() >= BLOCK_SIZE / 2 )
+	{
+		_blocks.push_back( new std::vector<T>() );
+		_blocks.back()->reserve( BLOCK_SIZE );
+		_tree.push_back( 0 );
+		// A new Fenwick node covers the blocks below it
+		size_t node = _blocks.size();
+		size_t low = node - ( node & -node );
+		for ( size_t child = node - 1; child > low; child -= child & -child )
+		{
+			_tree[node] += _tree[child];
+		}
+	}
+	_blocks.back()->push_back( value );
+	for ( size_t node = _blocks.size(); node < _tree.size(); node += node & -node )
+	{
+		_tree[node]++;
+	}
+	_size++;
+}
+
+template <typename T>
+const T & BlockedChain<T>::operator[]( size_t rank ) const
+{
+	size_t block;
+	size_t offset;
+	_locate( rank, block, offset );
+	return ( ( *_blocks[block] )[offset] );
+}
+
+template <typename T>
+const T * BlockedChain<T>::block( size_t rank, size_t & first, size_t & length ) const
+{
+	size_t block;
+	size_t offset;
+	_locate( rank, block, offset );
+	first = rank - offset;
+	length = _blocks[block]->size();
+	return ( &( *_blocks[block] )[0] );
+}
+
+template <typename T>
+void BlockedChain<T>::insert( size_t rank, const T & value )
+{
+	size_t block;
+	size_t offset;
+	if ( _blocks.empty() )
+	{
+		push_back( value );
+		return ;
+	}
+	if ( rank >= _size )
+	{
+		block = _blocks.size() - 1;
+		offset = _blocks[block]->size();
+	}
+	else
+	{
+		_locate( rank, block, offset );
+	}
+	_blocks[block]->insert( _blocks[block]->begin() + offset, value );
+	for ( size_t node = block + 1; node < _tree.size(); node += node & -node )
+	{
+		_tree[node]++;
+	}
+	_size++;
+	if ( _blocks[block]->size() >= BLOCK_SIZE )
+	{
+		_grow( block );
+	}
+}
+
+template <typename T>
+template <typename Sequence>
+void BlockedChain<T>::flatten( Sequence & out ) const
+{
+	for ( size_t i = 0; i < _blocks.size(); i++ )
+	{
+		out.insert( out.end(), _blocks[i]->begin(), _blocks[i]->end() );
+	}
+}
+
+// Finds the block holding rank by descending the Fenwick tree
+template <typename T>
+void BlockedChain<T>::_locate( size_t rank, size_t & block, size_t & offset ) const
+{
+	size_t count = _blocks.size();
+	size_t step = 1;
+	while ( step * 2 <= count )
+	{
+		step *= 2;
+	}
+	size_t node = 0;
+	for ( ; step > 0; step /= 2 )
+	{
+		if ( node + step <= count && static_cast<size_t>( _tree[node + step] ) <= rank )
+		{
+			node += step;
+			rank -= _tree[node];
+		}
+	}
+	block = node;
+	offset = rank;
+}
+
+// Splits a full block in two halves
+template <typename T>
+void BlockedChain<T>::_grow( size_t block )
+{
+	std::vector<T> & full = *_blocks[block];
+	std::vector<T> * half = new std::vector<T>( full.begin() + full.size() / 2, full.end() );
+	half->reserve( BLOCK_SIZE );
+	full.erase( full.begin() + full.size() / 2, full.end() );
+	_blocks.insert( _blocks.begin() + block + 1, half );
+	_rebuildTree( block + 1 );
+}
+
+/*
+ * Recomputes the Fenwick nodes from first on, in one pass pushing each
+ * node into its parent. Nodes in front of first cover only blocks in front
+ * of the split and keep their counts; the ones among them whose parent is
+ * rebuilt are the chain from first - 1 down by lowest bits.
+ */
+template <typename T>
+void BlockedChain<T>::_rebuildTree( size_t first )
+{
+	_tree.resize( _blocks.size() + 1 );
+	for ( size_t node = first; node < _tree.size(); node++ )
+	{
+		_tree[node] = _blocks[node - 1]->size();
+	}
+	for ( size_t node = first - 1; node > 0; node -= node & -node )
+	{
+		size_t parent = node + ( node & -node );
+		if ( parent < _tree.size() )
+		{
+			_tree[parent] += _tree[node];
+		}
+	}
+	for ( size_t node = first; node < _tree.size(); node++ )
+	{
+		size_t parent = node + ( node & -node );
+		if ( parent < _tree.size() )
+		{
+			_tree[parent] += _tree[node];
+		}
+	}
+}
+
+template <typename T>
+void BlockedChain<T>::_clear( void )
+{
+	for ( size_t i = 0; i < _blocks.size(); i++ )
+	{
+		delete _blocks[i];
+	}
+	_blocks.clear();
+	_tree.assign( 1, 0 );
+	_size = 0;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Sorts a raw binary file of native-endian 32-bit integers that may
+ *        not fit in memory. Chunks sized to the memory budget are sorted
+ *        with PmergeMe and written as runs to temporary files, which a
+ *        loser tree then merges through one buffer per run. With more runs
+ *        than the budget has buffers for, groups of runs are merged into
+ *        longer runs first.
+ */
+class ExternalSort
+{
+	private:
+		// Peak bytes per element while a chunk is read and sorted by the
+		// vector backend: the read buffer, the sorter's copy and its
+		// per-level keys and index arrays
+		static const size_t BYTES_PER_ELEMENT = 36;
+		// Smallest buffer per merged run; fewer bytes would turn the merge
+		// into small scattered reads
+		static const size_t MIN_BUFFER = 1 << 16;
+		// Most runs merged at once, under the usual limit of 1024 open files
+		static const size_t MAX_WAYS = 512;
+
+		size_t _budget;
+		int _threads;
+		std::string _directory;
+		// Temporary runs still on disk
+		std::vector<std::string> _runs;
+		size_t _elements;
+		size_t _runCount;
+		size_t _passes;
+		unsigned long _comparisons;
+
+		ExternalSort( const ExternalSort & src );
+		ExternalSort & operator=( const ExternalSort & src );
+
+		void _formRuns( std::FILE * input, const std::string & name, std::FILE * output,
+		                const std::string & outputName );
+		std::string _createRun( std::FILE ** file );
+		void _merge( const std::vector<std::string> & runs, std::FILE * output,
+		             const std::string & outputName );
+		void _removeRun( const std::string & path );
+
+	public:
+		ExternalSort( void );
+
+		/**
+		 * @param budget Bytes of memory the sort may hold at once
+		 * @param threads Threads each chunk sort may use
+		 * @param directory Where the temporary runs go
+		 */
+		ExternalSort( size_t budget, int threads, const std::string & directory );
+
+		/**
+		 * @brief Removes any temporary run left by a failed sort
+		 */
+		~ExternalSort( void );
+
+		/**
+		 * @brief Sorts input into output
+		 * @param input Binary file to sort, "-" for stdin
+		 * @param output File to write, "-" for stdout
+		 * @throws std::invalid_argument if output is the input file
+		 * @throws std::runtime_error on I/O errors or a partial integer
+		 */
+		void sort( const std::string & input, const std::string & output );
+
+		size_t getElements( void ) const;
+
+		/**
+		 * @return Runs written by the chunk sorts
+		 */
+		size_t getRuns( void ) const;
+
+		/**
+		 * @return Merge passes over the data, the final one included
+		 */
+		size_t getPasses( void ) const;
+
+		/**
+		 * @return Comparisons of the chunk sorts and of the loser trees
+		 */
+		unsigned long getComparisons( void ) const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef INPUT_LOADER_HPP
+#define INPUT_LOADER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads the integers to sort from arguments, a text file or a raw
+ *        binary file, and rejects any value outside [1, INT_MAX] or seen
+ *        twice. Files are read in large chunks and parsed in place, and
+ *        duplicates are found with a bitmap or a hash table in one pass.
+ */
+class InputLoader
+{
+	private:
+		// Bytes read per fread call
+		static const size_t CHUNK_SIZE = 1 << 20;
+
+		std::vector<int> _values;
+
+		void _parseText( const char * first, const char * last );
+		void _readText( std::FILE * file, const std::string & name );
+		void _readBinary( std::FILE * file, const std::string & name );
+		void _checkValues( void ) const;
+		void _checkDuplicates( int largest ) const;
+
+	public:
+		InputLoader( void );
+		InputLoader( const InputLoader & src );
+		~InputLoader( void );
+
+		/**
+		 * @brief Assignment operator
+		 * @param src Source object to assign from
+		 * @return Reference to this object
+		 */
+		InputLoader & operator=( const InputLoader & src );
+
+		/**
+		 * @brief Parses whitespace-separated integers from every argument
+		 * @param ac Number of arguments, av[0] included
+		 * @param av Arguments, av[0] is skipped
+		 */
+		void loadArguments( int ac, char ** av );
+
+		/**
+		 * @brief Reads the integers from a file
+		 * @param path File to read, "-" for stdin
+		 * @param binary Raw native-endian 32-bit ints instead of text
+		 */
+		void loadFile( const std::string & path, bool binary );
+
+		const std::vector<int> & getValues( void ) const;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef INSERTION_SCHEDULE_HPP
+#define INSERTION_SCHEDULE_HPP
+
+#include <vector>
+
+/**
+ * @brief Appends the 1-based pending indices in Ford-Johnson order: 1, then
+ *        each group from min( t_k, pendingSize ) down to t_(k-1) + 1
+ * @param pendingSize Number of pending elements
+ * @param schedule Receives the indices
+ */
+void buildInsertionSchedule( int pendingSize, std::vector<int> & schedule );
+
+/*
+ * Tracks where the partners of the current insertion group sit in the main
+ * chain. Partner a_i has i - 1 partners and every already inserted b_j
+ * ( j <= t_(k-1) ) in front of it, plus whichever elements of its own group
+ * landed before it. A Fenwick tree over ( 1 + landings ) per partner keeps
+ * both the lookup and the update at O(log n).
+ */
+class PartnerWindows
+{
+	private:
+		int _top;
+		int _first;
+		int _before;
+		std::vector<int> _tree;
+
+	public:
+		PartnerWindows( void );
+		PartnerWindows( const PartnerWindows & src );
+		~PartnerWindows( void );
+
+		PartnerWindows & operator=( const PartnerWindows & src );
+
+		/**
+		 * @brief Opens the search window of a pending element
+		 * @param index 1-based pending index, in schedule order
+		 * @param partners Number of pending elements that have a partner
+		 * @return Chain position of the partner, or -1 when it has none
+		 */
+		int open( int index, int partners );
+
+		/**
+		 * @brief Shifts every partner at or after position by one
+		 * @param position Chain index the element was inserted at
+		 */
+		void inserted( int position );
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef LOSER_TREE_HPP
+#define LOSER_TREE_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Tournament tree of losers over the heads of k sorted ways. Each
+ *        inner node keeps the way that lost the match played there, so
+ *        replacing the winner replays only its path to the root: one
+ *        comparison per level, ceil( log2( k ) ) in all. Ties go to the
+ *        lower way, which keeps the merge stable.
+ */
+class LoserTree
+{
+	private:
+		size_t _ways;
+		std::vector<int> _keys;
+		std::vector<bool> _closed;
+		// _losers[0] is the winner, _losers[1..k) the inner nodes; way i is
+		// the leaf at node k + i
+		std::vector<size_t> _losers;
+		size_t _live;
+		unsigned long _comparisons;
+
+		bool _beats( size_t a, size_t b );
+		size_t _play( size_t node );
+		void _replay( size_t way );
+
+	public:
+		LoserTree( void );
+
+		/**
+		 * @param ways Number of sorted ways, all closed until set
+		 */
+		LoserTree( size_t ways );
+		LoserTree( const LoserTree & src );
+		~LoserTree( void );
+
+		/**
+		 * @brief Assignment operator
+		 * @param src Source object to assign from
+		 * @return Reference to this object
+		 */
+		LoserTree & operator=( const LoserTree & src );
+
+		/**
+		 * @brief Sets the head of a way before build()
+		 */
+		void set( size_t way, int key );
+
+		/**
+		 * @brief Plays every match once, k - 1 comparisons
+		 */
+		void build( void );
+
+		bool isEmpty( void ) const;
+
+		/**
+		 * @return Way holding the smallest head
+		 */
+		size_t getWinner( void ) const;
+		int getKey( void ) const;
+
+		/**
+		 * @brief Replaces the winner's head with the next key of its way
+		 */
+		void replace( int key );
+
+		/**
+		 * @brief Closes the winner's way once it has no keys left
+		 */
+		void pop( void );
+
+		unsigned long getComparisons( void ) const;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef NODE_ARENA_HPP
+#define NODE_ARENA_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bump allocator over large slabs for short-lived container nodes.
+ *        Single allocations are never freed one by one: rewind() reuses the
+ *        slabs once no node is alive, and release() or the destructor
+ *        returns them to the heap in one go.
+ */
+class NodeArena
+{
+	private:
+		static const size_t SLAB_SIZE = 1 << 20;
+
+		std::vector<char *> _slabs;
+		// Requests larger than a slab get a block of their own
+		std::vector<char *> _large;
+		size_t _slab;
+		size_t _used;
+		size_t _allocations;
+
+		NodeArena( const NodeArena & src );
+		NodeArena & operator=( const NodeArena & src );
+
+	public:
+		NodeArena( void );
+		~NodeArena( void );
+
+		/**
+		 * @brief Carves bytes from the current slab
+		 * @param alignment Power of two the address must be a multiple of,
+		 *        at most the heap's own alignment
+		 */
+		void * allocate( size_t bytes, size_t alignment );
+
+		/**
+		 * @brief Makes every slab available again; nothing allocated from
+		 *        the arena may still be in use
+		 */
+		void rewind( void );
+
+		/**
+		 * @brief Frees every slab
+		 */
+		void release( void );
+
+		/**
+		 * @brief Number of allocate() calls since construction
+		 */
+		size_t getAllocations( void ) const;
+
+		/**
+		 * @brief Bytes held in slabs, oversized blocks not included
+		 */
+		size_t getReservedBytes( void ) const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef PAIR_KERNELS_HPP
+#define PAIR_KERNELS_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/*
+ * Pair formation for int keys ordered by std::less<int>: for every pair p in
+ * [first, last), compares keys[2p] with keys[2p + 1] and writes the smaller
+ * item index to smaller[p], the larger to larger[p] and its key to
+ * largerKeys[p]. Ties keep item 2p as smaller.
+ */
+typedef void ( *PairKernel )( const int * keys, int * smaller, int * larger,
+                              int * largerKeys, size_t first, size_t last );
+
+void pairIntScalar( const int * keys, int * smaller, int * larger, int * largerKeys,
+                    size_t first, size_t last );
+void pairIntSse41( const int * keys, int * smaller, int * larger, int * largerKeys,
+                   size_t first, size_t last );
+void pairIntAvx2( const int * keys, int * smaller, int * larger, int * largerKeys,
+                  size_t first, size_t last );
+
+/**
+ * @brief Widest kernel this CPU supports, picked once at first call
+ * @param name Receives "avx2", "sse4.1" or "scalar" when not null
+ */
+PairKernel selectPairKernel( const char ** name );
+
+/**
+ * @brief Routes pair formation of a level to a vector kernel when its key
+ *        and ordering have one; other keys return false and pair with the
+ *        generic loop
+ */
+template <typename T, typename Compare>
+struct PairFormation
+{
+	static bool run( const std::vector<T> &, std::vector<int> &, std::vector<int> &,
+	                 std::vector<T> &, size_t, size_t )
+	{
+		return ( false );
+	}
+};
+
+template <>
+struct PairFormation< int, std::less<int> >
+{
+	static bool run( const std::vector<int> & keys, std::vector<int> & smaller,
+	                 std::vector<int> & larger, std::vector<int> & largerKeys,
+	                 size_t first, size_t last )
+	{
+		static PairKernel kernel = selectPairKernel( 0 );
+		kernel( &keys[0], &smaller[0], &larger[0], &largerKeys[0], first, last );
+		return ( true );
+	}
+};
+
+#endif
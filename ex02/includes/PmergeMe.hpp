@@ -2,90 +2,279 @@
 #define PLEASE_MERGE_ME_HPP
 
 #include "utils.hpp"
+#include "InsertionSchedule.hpp"
+#include "BlockedChain.hpp"
+#include "ThreadPool.hpp"
+#include "PairKernels.hpp"
+#include "PoolAllocator.hpp"
+#include <deque>
+#include <functional>
 
-#define VECTOR 0
-#define LIST 1
+/**
+ * @brief Maps a container type to the same container holding another type
+ */
+template <typename Container, typename T>
+struct Rebind;
 
+template <typename U, typename A, typename T>
+struct Rebind< std::vector<U, A>, T >
+{
+	typedef std::vector<T> type;
+};
+
+template <typename U, typename A, typename T>
+struct Rebind< std::deque<U, A>, T >
+{
+	typedef std::deque<T> type;
+};
+
+// List nodes come from the sorter's arena, see PmergeMe::_arena
+template <typename U, typename A, typename T>
+struct Rebind< std::list<U, A>, T >
+{
+	typedef std::list< T, PoolAllocator<T> > type;
+};
+
+/**
+ * @brief Ford-Johnson merge-insertion sort over any sequence container.
+ *        Random-access containers sort contiguous key arrays linked by int
+ *        index permutations; node-based containers insert by splicing.
+ *        The path is picked from the iterator category.
+ * @tparam Container std::vector, std::deque or std::list
+ * @tparam Compare Strict weak ordering on the container's value_type
+ */
+template < typename Container,
+           typename Compare = std::less<typename Container::value_type> >
 class PmergeMe
 {
 	private:
-		bool _container;
-		int _straggler;
+		typedef typename Container::value_type value_type;
+		// Keys of one recursion level, indexed by item
+		typedef std::vector<value_type> Keys;
+		// Item indices in insertion order, for the random-access path
+		typedef BlockedChain<int> MainChain;
+		// ( key, id ) where id locates the element's pair one level down
+		typedef std::pair<value_type, int> Element;
+		typedef typename Rebind<Container, Element>::type Chain;
+		typedef typename Chain::iterator ChainIterator;
+		// Rank index over the nodes of the node-based path
+		typedef BlockedChain<ChainIterator> NodeIndex;
 
-		PmergeMe( void );
-		int _getJacobstahlNumber( int n );
-
-		std::vector<int> * _unsortedVector;
-		std::vector<int> * _sortedVector;
-
-		void _fillVectorFromArray( int * array, int array_size );
-		void _sortVector( void );
-		bool _isVectorAlreadySorted( void );
-		std::vector< std::pair<int, int> > _splitIntoPairs( std::vector<int> & unsortedVector );
-		void _sortEachPair( std::vector< std::pair<int, int> > & splitVector );
-		void _sortPairsByLargestValue( std::vector< std::pair<int, int> > & splitVector );
-		void _insertionSortPairs( std::vector< std::pair<int, int> > & splitVector, int n );
-		void _insertElement( std::vector< std::pair<int, int> > & splitVector,
-		                     std::pair<int, int> element, int n );
-		void _createSortedSequence( std::vector< std::pair<int, int> > & splitVector );
-		std::vector<int> _createIndexInsertSequence( std::vector<int> pending );
-		std::vector<int> _buildJacobstahlInsertionSequence( int size );
-		void _insertAtBisectedIndex( std::vector<int> & vector, int element );
-		int _bisect( std::vector<int> vector, int x );
-		void _extractStraggler( std::vector<int> & unsortedVector );
-		void _insertStraggler( std::vector<int> & sortedVector );
-
-		std::list<int> * _unsortedList;
-		std::list<int> * _sortedList;
-
-		void _fillListFromArray( int * array, int array_size );
-		void _sortList( void );
-		bool _isListAlreadySorted( void );
-		std::list< std::pair<int, int> > _splitIntoPairs( std::list<int> & unsortedList );
-		void _sortEachPair( std::list< std::pair<int, int> > & splitList );
-		void _sortPairsByLargestValue( std::list< std::pair<int, int> > & splitList );
-		void _insertionSortPairs( std::list< std::pair<int, int> > & splitList, int n );
-		void _insertElement( std::list< std::pair<int, int> > & splitList,
-		                     std::pair<int, int> element, int n );
-		void _createSortedSequence( std::list< std::pair<int, int> > & splitList );
-		std::list<int> _createIndexInsertSequence( std::list<int> pending );
-
-		/**
-		 * @brief Builds Jacobsthal sequence for insertion order
-		 * @param pending List of pending elements
-		 * @return List of Jacobsthal numbers
-		 */
-		std::list<int> _buildJacobstahlInsertionSequence( std::list<int> pending );
-
-		/**
-		 * @brief Inserts element using binary search
-		 * @param list List to insert into
-		 * @param element Element to insert
-		 */
-		void _insertAtBisectedIndex( std::list<int> & list, int element );
-		int _bisect( std::list<int> list, int x );
-		void _extractStraggler( std::list<int> & unsortedList );
-		void _insertStraggler( std::list<int> & sortedList );
-
-		template <typename T>
-		void _printVector( std::vector<T> & vector, std::string name,
-		                   std::string color );
-
-		std::string _getVectorContentsAsString( std::vector<int> & vector );
-		std::string _getVectorContentsAsString( std::vector< std::pair<int, int> > &
-		                                        vector );
-
-		template <typename T>
-		void _printList( std::list<T> & list, std::string name,
-		                   std::string color );
-
-		std::string _getListContentsAsString( std::list<int> & list );
-		std::string _getListContentsAsString( std::list< std::pair<int, int> > &
-		                                        list );
+		// Levels with fewer pairs than this pair on the calling thread
+		static const int PARALLEL_PAIRS = 1 << 15;
+		static const int PAIRS_PER_CHUNK = 1 << 13;
+		// Shortest run merged as is; shorter runs go to merge-insertion
+		static const size_t MIN_RUN = 32;
+		// Short runs the run scan may meet before long runs pay for it
+		static const long RUN_SLACK = 8;
+		// Smaller inputs skip the run scan, whose probe would be a visible
+		// share of their comparisons
+		static const size_t ADAPTIVE_MIN = 1 << 12;
+		// Size ratio from which a merge gallops through the longer side
+		static const size_t GALLOP_RATIO = 8;
+
+		enum RunKind
+		{
+			ASCENDING,
+			DESCENDING,
+			DISORDERED
+		};
+
+		// Positions [first, last) of the input and how to sort them
+		struct Run
+		{
+			size_t first;
+			size_t last;
+			RunKind kind;
+
+			Run( size_t from, size_t to, RunKind runKind )
+				: first( from ), last( to ), kind( runKind ) {}
+		};
+
+		/**
+		 * @brief Compare-swap of a slice of pairs, one chunk per task run
+		 */
+		class PairingTask : public ThreadPool::Task
+		{
+			public:
+				PairingTask( PmergeMe & sorter, const Keys & keys, std::vector<int> & smaller,
+				             std::vector<int> & larger, Keys & largerKeys );
+				virtual void run( size_t chunk );
+
+			private:
+				PmergeMe & _sorter;
+				const Keys & _keys;
+				std::vector<int> & _smaller;
+				std::vector<int> & _larger;
+				Keys & _largerKeys;
+		};
+
+		// Points the sorter's _pool at a pool that lives as long as the
+		// scope, and clears it on every way out, exceptions included
+		class PoolScope
+		{
+			public:
+				PoolScope( ThreadPool *& pool, int threads )
+					: _pool( pool ), _local( threads )
+				{
+					_pool = threads > 1 ? &_local : 0;
+				}
+				~PoolScope( void ) { _pool = 0; }
+
+			private:
+				ThreadPool *& _pool;
+				ThreadPool _local;
+
+				PoolScope( const PoolScope & src );
+				PoolScope & operator=( const PoolScope & src );
+		};
+
+		// Key of a main-chain item
+		class ItemKey
+		{
+			public:
+				ItemKey( const Keys & keys ) : _keys( keys ) {}
+				const value_type & operator()( int item ) const { return ( _keys[item] ); }
+
+			private:
+				const Keys & _keys;
+		};
+
+		// Counted ordering of ( key, id ) elements, for std::list::merge
+		class ElementLess
+		{
+			public:
+				ElementLess( PmergeMe & sorter ) : _sorter( sorter ) {}
+				bool operator()( const Element & a, const Element & b ) const
+				{
+					return ( _sorter._less( a.first, b.first ) );
+				}
+
+			private:
+				PmergeMe & _sorter;
+		};
+
+		// Key of a node-based chain node
+		class NodeKey
+		{
+			public:
+				const value_type & operator()( ChainIterator node ) const { return ( node->first ); }
+		};
+
+		Container _sequence;
+		Compare _compare;
+		std::vector<int> _order;
+		unsigned long _comparisons;
+		int _threads;
+		// Set by PoolScope while a parallel sort runs, null otherwise
+		ThreadPool * _pool;
+		// Node storage of the node-based path, freed with the sorter
+		NodeArena _arena;
+		// False sends the node-based path to the global heap instead
+		bool _nodeArena;
+		// False skips the sorted check and the run scan
+		bool _adaptive;
+
+		/**
+		 * @brief Counted comparison, every key comparison of sort() goes
+		 *        through here
+		 */
+		bool _less( const value_type & a, const value_type & b );
+		bool _isAlreadySorted( void ) const;
+
+		void _sort( std::random_access_iterator_tag );
+		void _sort( std::bidirectional_iterator_tag );
+
+		/**
+		 * @brief One counted pass splitting the input into ascending and
+		 *        strictly descending runs of at least MIN_RUN, with the
+		 *        stretches between them marked disordered. Gives up and
+		 *        marks the rest disordered once short runs have
+		 *        outnumbered RUN_SLACK plus one per MIN_RUN elements of
+		 *        the long runs found, so random input costs a handful of
+		 *        comparisons.
+		 * @param runs Receives the runs in input order
+		 */
+		void _findRuns( std::vector<Run> & runs );
+
+		/**
+		 * @brief Sorts each run into order, then merges neighbouring runs
+		 *        pairwise until one is left
+		 * @param keys Input keys
+		 * @param runs Runs covering keys, from _findRuns()
+		 * @param order Receives the item indices in sorted order
+		 */
+		void _sortRuns( const Keys & keys, const std::vector<Run> & runs,
+		                std::vector<int> & order );
+		void _mergeRuns( const Keys & keys, const int * a, size_t aLength, const int * b,
+		                 size_t bLength, int * out );
+
+		/**
+		 * @brief Exponential then binary search for the number of leading
+		 *        entries of range that go before key: those less than key,
+		 *        or with upper, those not greater than key
+		 * @param keyOf Maps an entry to its key
+		 */
+		template <typename Entry, typename KeyOf>
+		size_t _gallop( const Entry * range, size_t length, const value_type & key, bool upper,
+		                const KeyOf & keyOf );
+		void _sortRuns( Chain & elements, const std::vector<Run> & runs );
+
+		/**
+		 * @brief Merges sorted right into sorted left, splicing; galloping
+		 *        like the random-access merge when one side is much shorter
+		 */
+		void _mergeChains( Chain & left, Chain & right );
+
+		/**
+		 * @brief Ford-Johnson sort of one level's keys
+		 * @param keys Keys of the level's items
+		 * @param order Receives the item indices in sorted order
+		 */
+		void _mergeInsertion( const Keys & keys, std::vector<int> & order );
+
+		/**
+		 * @brief Compare-swaps pairs [first, last): item 2p and 2p + 1 go to
+		 *        smaller and larger, the larger key to largerKeys. Goes
+		 *        through a SIMD kernel when the key and order have one.
+		 */
+		void _pairRange( const Keys & keys, std::vector<int> & smaller, std::vector<int> & larger,
+		                 Keys & largerKeys, size_t first, size_t last );
+
+		/**
+		 * @brief Ford-Johnson sort of ( key, id ) nodes, splicing in place
+		 * @param elements Elements to sort in place
+		 */
+		void _mergeInsertion( Chain & elements );
+
+		/**
+		 * @brief Upper-bound binary search over chain[0, window)
+		 * @param chain Main chain, or rank index over the chain's nodes
+		 * @param window Chain position of the element's partner, which
+		 *        bounds the search as Ford-Johnson requires
+		 * @param keyOf Maps a chain entry to its key
+		 * @return Index to insert at
+		 */
+		template <typename Entry, typename KeyOf>
+		int _bisectIndex( const BlockedChain<Entry> & chain, const value_type & key, int window,
+		                  const KeyOf & keyOf );
+		template <typename Entry, typename KeyOf>
+		int _bisectBlock( const Entry * entries, int count, const value_type & key,
+		                  const KeyOf & keyOf );
 
 	public:
-		PmergeMe( int * array, int array_size, bool container );
-		PmergeMe( PmergeMe & src );
+		PmergeMe( void );
+
+		/**
+		 * @brief Copies the range to sort
+		 * @param first Start of the input range
+		 * @param last End of the input range
+		 * @param compare Ordering to sort by
+		 */
+		template <typename InputIterator>
+		PmergeMe( InputIterator first, InputIterator last,
+		          const Compare & compare = Compare() );
+		PmergeMe( const PmergeMe & src );
 		~PmergeMe( void );
 
 		/**
@@ -93,11 +282,56 @@ class PmergeMe
 		 * @param src Source object to assign from
 		 * @return Reference to this object
 		 */
-		PmergeMe & operator=( PmergeMe & src );
+		PmergeMe & operator=( const PmergeMe & src );
+
+		/**
+		 * @brief Threads sort() may use. Above PARALLEL_PAIRS pairs, the
+		 *        compare-swap of each level is split across them on
+		 *        random-access backends; the result and the comparison
+		 *        count match the sequential run. Compare must be safe to
+		 *        call concurrently.
+		 * @param threads Thread count, the calling thread included
+		 */
+		void setThreads( int threads );
+
+		/**
+		 * @brief Whether the node-based path draws its nodes from the
+		 *        sorter's arena, the default, or from the global heap; the
+		 *        heap is there to measure the arena against
+		 */
+		void setNodeArena( bool enabled );
+
+		/**
+		 * @brief Whether sort() looks for existing order first, the
+		 *        default: the sorted check and, from ADAPTIVE_MIN
+		 *        elements, the run scan. Off, every input goes through
+		 *        Ford-Johnson as a whole, the baseline the adaptive path
+		 *        is measured against
+		 */
+		void setAdaptive( bool enabled );
 
 		void sort( void );
-		std::vector<int> & getSortedVector( void );
-		std::list<int> & getSortedList( void );
+		const Container & getSequence( void ) const;
+
+		/**
+		 * @brief Where each sorted element was before sort(): element i of
+		 *        getSequence() was at position getOrder()[i]
+		 */
+		const std::vector<int> & getOrder( void ) const;
+
+		/**
+		 * @brief Number of key comparisons made by sort(), not counting the
+		 *        early-out scan for already sorted input
+		 */
+		unsigned long getComparisons( void ) const;
+
+		/**
+		 * @brief Arena of the node-based path, for its allocation count and
+		 *        reserved bytes
+		 */
+		const NodeArena & getArena( void ) const;
 };
 
+#include "PmergeMe.tpp"
+
 #endif
@@ -0,0 +1,681 @@
+#ifndef PLEASE_MERGE_ME_TPP
+#define PLEASE_MERGE_ME_TPP
+
+// Default constructor
+template <typename Container, typename Compare>
+PmergeMe<Container, Compare>::PmergeMe( void )
+	: _comparisons( 0 ), _threads( 1 ), _pool( 0 ), _nodeArena( true ), _adaptive( true ) {}
+
+// Range constructor
+template <typename Container, typename Compare>
+template <typename InputIterator>
+PmergeMe<Container, Compare>::PmergeMe( InputIterator first, InputIterator last,
+                                        const Compare & compare )
+	: _sequence( first, last ), _compare( compare ), _comparisons( 0 ), _threads( 1 ),
+	  _pool( 0 ), _nodeArena( true ), _adaptive( true ) {}
+
+// Copy constructor
+template <typename Container, typename Compare>
+PmergeMe<Container, Compare>::PmergeMe( const PmergeMe & src ) : _pool( 0 )
+{
+	*this = src;
+}
+
+// Destructor
+template <typename Container, typename Compare>
+PmergeMe<Container, Compare>::~PmergeMe( void ) {}
+
+// Assignment operator
+template <typename Container, typename Compare>
+PmergeMe<Container, Compare> & PmergeMe<Container, Compare>::operator=( const PmergeMe & src )
+{
+	if ( this != &src )
+	{
+		_sequence = src._sequence;
+		_compare = src._compare;
+		_comparisons = src._comparisons;
+		_threads = src._threads;
+		_nodeArena = src._nodeArena;
+		_adaptive = src._adaptive;
+		_order = src._order;
+	}
+	return ( *this );
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::setThreads( int threads )
+{
+	_threads = threads < 1 ? 1 : threads;
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::setNodeArena( bool enabled )
+{
+	_nodeArena = enabled;
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::setAdaptive( bool enabled )
+{
+	_adaptive = enabled;
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::sort( void )
+{
+	printVerbose( _sequence, "Unsorted", PURPLE );
+	if ( _adaptive && _isAlreadySorted() )
+	{
+		_order.resize( _sequence.size() );
+		for ( size_t i = 0; i < _order.size(); i++ )
+		{
+			_order[i] = i;
+		}
+		return ;
+	}
+	_sort( typename std::iterator_traits<typename Container::iterator>::iterator_category() );
+	printVerbose( _sequence, "Sorted", GREEN );
+}
+
+template <typename Container, typename Compare>
+const Container & PmergeMe<Container, Compare>::getSequence( void ) const
+{
+	return ( _sequence );
+}
+
+template <typename Container, typename Compare>
+const std::vector<int> & PmergeMe<Container, Compare>::getOrder( void ) const
+{
+	return ( _order );
+}
+
+template <typename Container, typename Compare>
+unsigned long PmergeMe<Container, Compare>::getComparisons( void ) const
+{
+	return ( _comparisons );
+}
+
+template <typename Container, typename Compare>
+const NodeArena & PmergeMe<Container, Compare>::getArena( void ) const
+{
+	return ( _arena );
+}
+
+template <typename Container, typename Compare>
+bool PmergeMe<Container, Compare>::_less( const value_type & a, const value_type & b )
+{
+	_comparisons++;
+	return ( _compare( a, b ) );
+}
+
+template <typename Container, typename Compare>
+bool PmergeMe<Container, Compare>::_isAlreadySorted( void ) const
+{
+	typename Container::const_iterator it = _sequence.begin();
+	if ( it == _sequence.end() )
+	{
+		return ( true );
+	}
+	typename Container::const_iterator next = it;
+	for ( ++next; next != _sequence.end(); it++, next++ )
+	{
+		if ( _compare( *next, *it ) )
+		{
+			return ( false );
+		}
+	}
+	return ( true );
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_sort( std::random_access_iterator_tag )
+{
+	Keys keys( _sequence.begin(), _sequence.end() );
+	std::vector<int> order;
+	bool parallel = _threads > 1 && keys.size() / 2 >= static_cast<size_t>( PARALLEL_PAIRS );
+	// A one-thread pool starts no worker and leaves _pool null
+	PoolScope scope( _pool, parallel ? _threads : 1 );
+	std::vector<Run> runs;
+	if ( _adaptive && keys.size() >= ADAPTIVE_MIN )
+	{
+		_findRuns( runs );
+	}
+	if ( runs.size() > 1 || ( runs.size() == 1 && runs[0].kind != DISORDERED ) )
+	{
+		_sortRuns( keys, runs, order );
+	}
+	else
+	{
+		_mergeInsertion( keys, order );
+	}
+	for ( size_t i = 0; i < order.size(); i++ )
+	{
+		_sequence[i] = keys[order[i]];
+	}
+	_order.swap( order );
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_sort( std::bidirectional_iterator_tag )
+{
+	// No node from a previous sort is alive here, so its slabs are reused
+	_arena.rewind();
+	typename Chain::allocator_type allocator( _nodeArena ? &_arena : 0 );
+	Chain elements( allocator );
+	typename Container::iterator it = _sequence.begin();
+	for ( int id = 0; it != _sequence.end(); it++, id++ )
+	{
+		elements.push_back( Element( *it, id ) );
+	}
+	std::vector<Run> runs;
+	if ( _adaptive && elements.size() >= ADAPTIVE_MIN )
+	{
+		_findRuns( runs );
+	}
+	if ( runs.size() > 1 || ( runs.size() == 1 && runs[0].kind != DISORDERED ) )
+	{
+		_sortRuns( elements, runs );
+	}
+	else
+	{
+		_mergeInsertion( elements );
+	}
+	it = _sequence.begin();
+	_order.clear();
+	_order.reserve( elements.size() );
+	ChainIterator eit = elements.begin();
+	for ( ; eit != elements.end(); eit++, it++ )
+	{
+		*it = eit->first;
+		_order.push_back( eit->second );
+	}
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_findRuns( std::vector<Run> & runs )
+{
+	size_t size = _sequence.size();
+	size_t position = 0;
+	// Start of the open disordered stretch, size while there is none
+	size_t disordered = size;
+	long budget = RUN_SLACK;
+	typename Container::const_iterator it = _sequence.begin();
+
+	while ( position < size && budget >= 0 )
+	{
+		typename Container::const_iterator last = it;
+		typename Container::const_iterator next = it;
+		size_t length = 1;
+		bool descending = false;
+		if ( ++next != _sequence.end() )
+		{
+			descending = _less( *next, *last );
+			last = next++;
+			length = 2;
+			while ( next != _sequence.end() && _less( *next, *last ) == descending )
+			{
+				last = next++;
+				length++;
+			}
+		}
+		if ( length >= MIN_RUN )
+		{
+			if ( disordered < position )
+			{
+				runs.push_back( Run( disordered, position, DISORDERED ) );
+			}
+			disordered = size;
+			runs.push_back( Run( position, position + length, descending ? DESCENDING : ASCENDING ) );
+			budget += length / MIN_RUN;
+		}
+		else
+		{
+			disordered = std::min( disordered, position );
+			budget--;
+		}
+		position += length;
+		it = next;
+	}
+	if ( disordered < size )
+	{
+		runs.push_back( Run( disordered, size, DISORDERED ) );
+	}
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_sortRuns( const Keys & keys, const std::vector<Run> & runs,
+                                              std::vector<int> & order )
+{
+	order.resize( keys.size() );
+	std::vector<size_t> bounds;
+	typename std::vector<Run>::const_iterator run = runs.begin();
+	for ( ; run != runs.end(); run++ )
+	{
+		size_t length = run->last - run->first;
+		bounds.push_back( run->first );
+		if ( run->kind == DISORDERED )
+		{
+			Keys piece( keys.begin() + run->first, keys.begin() + run->last );
+			std::vector<int> pieceOrder;
+			_mergeInsertion( piece, pieceOrder );
+			for ( size_t i = 0; i < length; i++ )
+			{
+				order[run->first + i] = run->first + pieceOrder[i];
+			}
+		}
+		else
+		{
+			for ( size_t i = 0; i < length; i++ )
+			{
+				order[run->first + i] = run->kind == ASCENDING ? run->first + i : run->last - 1 - i;
+			}
+		}
+	}
+	bounds.push_back( keys.size() );
+	printVerbose( bounds, "Run bounds", CYAN );
+
+	std::vector<int> merged( order.size() );
+	while ( bounds.size() > 2 )
+	{
+		std::vector<size_t> mergedBounds;
+		size_t pieces = bounds.size() - 1;
+		for ( size_t p = 0; p < pieces; p += 2 )
+		{
+			size_t first = bounds[p];
+			size_t middle = bounds[p + 1];
+			size_t last = p + 1 < pieces ? bounds[p + 2] : middle;
+			_mergeRuns( keys, &order[first], middle - first, &order[0] + middle, last - middle,
+			            &merged[first] );
+			mergedBounds.push_back( first );
+		}
+		mergedBounds.push_back( order.size() );
+		order.swap( merged );
+		bounds.swap( mergedBounds );
+	}
+}
+
+// Ties keep items of a first, in the linear and both galloping merges
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_mergeRuns( const Keys & keys, const int * a, size_t aLength,
+                                               const int * b, size_t bLength, int * out )
+{
+	ItemKey keyOf( keys );
+	size_t i = 0;
+	size_t j = 0;
+
+	if ( bLength * GALLOP_RATIO <= aLength )
+	{
+		for ( ; j < bLength; j++ )
+		{
+			size_t skip = _gallop( a + i, aLength - i, keys[b[j]], true, keyOf );
+			out = std::copy( a + i, a + i + skip, out );
+			i += skip;
+			*out++ = b[j];
+		}
+	}
+	else if ( aLength * GALLOP_RATIO <= bLength )
+	{
+		for ( ; i < aLength; i++ )
+		{
+			size_t skip = _gallop( b + j, bLength - j, keys[a[i]], false, keyOf );
+			out = std::copy( b + j, b + j + skip, out );
+			j += skip;
+			*out++ = a[i];
+		}
+	}
+	else
+	{
+		while ( i < aLength && j < bLength )
+		{
+			*out++ = _less( keys[b[j]], keys[a[i]] ) ? b[j++] : a[i++];
+		}
+	}
+	out = std::copy( a + i, a + aLength, out );
+	std::copy( b + j, b + bLength, out );
+}
+
+template <typename Container, typename Compare>
+template <typename Entry, typename KeyOf>
+size_t PmergeMe<Container, Compare>::_gallop( const Entry * range, size_t length,
+                                              const value_type & key, bool upper,
+                                              const KeyOf & keyOf )
+{
+	size_t low = 0;
+	size_t bound = 1;
+
+	// Probes 1, 3, 7, ... until one does not go before key
+	while ( bound <= length
+	        && ( upper ? !_less( key, keyOf( range[bound - 1] ) )
+	                   : _less( keyOf( range[bound - 1] ), key ) ) )
+	{
+		low = bound;
+		bound = bound * 2 + 1;
+	}
+	size_t high = bound <= length ? bound - 1 : length;
+	while ( low < high )
+	{
+		size_t mid = ( low + high ) / 2;
+		if ( upper ? !_less( key, keyOf( range[mid] ) ) : _less( keyOf( range[mid] ), key ) )
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	return ( low );
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_mergeInsertion( const Keys & keys, std::vector<int> & order )
+{
+	int size = keys.size();
+	order.clear();
+	if ( size < 2 )
+	{
+		order.resize( size, 0 );
+		return ;
+	}
+	int pairs = size / 2;
+	std::vector<int> smaller( pairs );
+	std::vector<int> larger( pairs );
+	std::vector<int> pairOrder;
+	{
+		// Only the recursion reads the larger keys, so they go before insertion
+		Keys largerKeys( pairs );
+		if ( _pool != 0 && pairs >= PARALLEL_PAIRS )
+		{
+			PairingTask task( *this, keys, smaller, larger, largerKeys );
+			_pool->run( task, ( pairs + PAIRS_PER_CHUNK - 1 ) / PAIRS_PER_CHUNK );
+		}
+		else
+		{
+			_pairRange( keys, smaller, larger, largerKeys, 0, pairs );
+		}
+		_mergeInsertion( largerKeys, pairOrder );
+	}
+
+	MainChain chain;
+	std::vector<int> pending;
+	pending.reserve( size - pairs );
+	std::vector<int>::iterator it = pairOrder.begin();
+	for ( ; it != pairOrder.end(); it++ )
+	{
+		chain.push_back( larger[*it] );
+		pending.push_back( smaller[*it] );
+	}
+	// The straggler has no partner and joins the schedule as the last one
+	if ( size % 2 != 0 )
+	{
+		pending.push_back( size - 1 );
+	}
+	printVerbose( keys, "Level keys", YELLOW );
+	printVerbose( pending, "Pending items", CYAN );
+	std::vector<int> schedule;
+	buildInsertionSchedule( pending.size(), schedule );
+	printVerbose( schedule, "Index Seq", PURPLE );
+	ItemKey keyOf( keys );
+	PartnerWindows windows;
+	std::vector<int>::iterator sit = schedule.begin();
+	for ( ; sit != schedule.end(); sit++ )
+	{
+		int item = pending[*sit - 1];
+		int window = windows.open( *sit, pairs );
+		if ( window < 0 )
+		{
+			window = chain.size();
+		}
+		int position = _bisectIndex( chain, keys[item], window, keyOf );
+		chain.insert( position, item );
+		windows.inserted( position );
+	}
+	order.reserve( size );
+	chain.flatten( order );
+}
+
+// Callers on other threads pass disjoint ranges and so write disjoint slots
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_pairRange( const Keys & keys, std::vector<int> & smaller,
+                                               std::vector<int> & larger, Keys & largerKeys,
+                                               size_t first, size_t last )
+{
+	if ( !PairFormation<value_type, Compare>::run( keys, smaller, larger, largerKeys,
+	                                               first, last ) )
+	{
+		for ( size_t pair = first; pair < last; pair++ )
+		{
+			int a = 2 * pair;
+			int b = a + 1;
+			bool swap = _compare( keys[b], keys[a] );
+			smaller[pair] = swap ? b : a;
+			larger[pair] = swap ? a : b;
+			largerKeys[pair] = keys[larger[pair]];
+		}
+	}
+	__sync_fetch_and_add( &_comparisons, last - first );
+}
+
+template <typename Container, typename Compare>
+PmergeMe<Container, Compare>::PairingTask::PairingTask( PmergeMe & sorter, const Keys & keys,
+                                                        std::vector<int> & smaller,
+                                                        std::vector<int> & larger,
+                                                        Keys & largerKeys )
+	: _sorter( sorter ), _keys( keys ), _smaller( smaller ), _larger( larger ),
+	  _largerKeys( largerKeys ) {}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::PairingTask::run( size_t chunk )
+{
+	size_t begin = chunk * PAIRS_PER_CHUNK;
+	size_t end = std::min( begin + PAIRS_PER_CHUNK, _smaller.size() );
+	_sorter._pairRange( _keys, _smaller, _larger, _largerKeys, begin, end );
+}
+
+// Merges with a binary counter of runs, like std::list::sort, all by splicing
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_sortRuns( Chain & elements, const std::vector<Run> & runs )
+{
+	Chain empty( elements.get_allocator() );
+	std::vector<Chain> counter( 1, empty );
+	typename std::vector<Run>::const_iterator run = runs.begin();
+	for ( ; run != runs.end(); run++ )
+	{
+		Chain carry( elements.get_allocator() );
+		ChainIterator stop = elements.begin();
+		std::advance( stop, run->last - run->first );
+		carry.splice( carry.end(), elements, elements.begin(), stop );
+		if ( run->kind == DESCENDING )
+		{
+			carry.reverse();
+		}
+		else if ( run->kind == DISORDERED )
+		{
+			_mergeInsertion( carry );
+		}
+		size_t level = 0;
+		for ( ; level < counter.size() && !counter[level].empty(); level++ )
+		{
+			_mergeChains( counter[level], carry );
+			counter[level].swap( carry );
+		}
+		if ( level == counter.size() )
+		{
+			counter.push_back( empty );
+		}
+		counter[level].swap( carry );
+	}
+	// Higher levels hold older runs, further left
+	for ( size_t level = 0; level < counter.size(); level++ )
+	{
+		_mergeChains( counter[level], elements );
+		elements.swap( counter[level] );
+	}
+}
+
+// The gallop needs random access, so it runs over a vector of the longer side's nodes
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_mergeChains( Chain & left, Chain & right )
+{
+	bool rightShort = right.size() * GALLOP_RATIO <= left.size();
+	if ( !rightShort && left.size() * GALLOP_RATIO > right.size() )
+	{
+		left.merge( right, ElementLess( *this ) );
+		return ;
+	}
+	Chain & longer = rightShort ? left : right;
+	Chain & shorter = rightShort ? right : left;
+	std::vector<ChainIterator> nodes;
+	nodes.reserve( longer.size() );
+	for ( ChainIterator it = longer.begin(); it != longer.end(); it++ )
+	{
+		nodes.push_back( it );
+	}
+	size_t placed = 0;
+	while ( !shorter.empty() )
+	{
+		ChainIterator node = shorter.begin();
+		placed += _gallop( &nodes[0] + placed, nodes.size() - placed, node->first, rightShort,
+		                   NodeKey() );
+		longer.splice( placed < nodes.size() ? nodes[placed] : longer.end(), shorter, node );
+	}
+	if ( !rightShort )
+	{
+		left.swap( right );
+	}
+}
+
+template <typename Container, typename Compare>
+void PmergeMe<Container, Compare>::_mergeInsertion( Chain & elements )
+{
+	if ( elements.size() < 2 )
+	{
+		return ;
+	}
+	Chain smaller( elements.get_allocator() );
+	Chain larger( elements.get_allocator() );
+	Chain order( elements.get_allocator() );
+	std::vector<ChainIterator> smallerAt;
+	std::vector<ChainIterator> largerAt;
+	ChainIterator it = elements.begin();
+	while ( it != elements.end() )
+	{
+		ChainIterator first = it++;
+		if ( it == elements.end() )
+		{
+			break ;
+		}
+		ChainIterator second = it++;
+		if ( _less( second->first, first->first ) )
+		{
+			std::swap( first, second );
+		}
+		smaller.splice( smaller.end(), elements, first );
+		larger.splice( larger.end(), elements, second );
+		smallerAt.push_back( --smaller.end() );
+		largerAt.push_back( --larger.end() );
+		order.push_back( Element( second->first, order.size() ) );
+	}
+	_mergeInsertion( order );
+
+	Chain chain( elements.get_allocator() );
+	Chain pending( elements.get_allocator() );
+	for ( it = order.begin(); it != order.end(); it++ )
+	{
+		chain.splice( chain.end(), larger, largerAt[it->second] );
+		pending.splice( pending.end(), smaller, smallerAt[it->second] );
+	}
+	// Only the straggler, if any, is left in elements
+	pending.splice( pending.end(), elements );
+	printVerbose( chain, "Main chain", GREEN );
+	printVerbose( pending, "Pending", CYAN );
+	// Rank index over the chain nodes, so a search never walks the list
+	NodeIndex index;
+	for ( it = chain.begin(); it != chain.end(); it++ )
+	{
+		index.push_back( it );
+	}
+	std::vector<ChainIterator> pendingAt;
+	pendingAt.reserve( pending.size() );
+	for ( it = pending.begin(); it != pending.end(); it++ )
+	{
+		pendingAt.push_back( it );
+	}
+	std::vector<int> schedule;
+	buildInsertionSchedule( pending.size(), schedule );
+	printVerbose( schedule, "Index Seq", PURPLE );
+	PartnerWindows windows;
+	int partners = order.size();
+	std::vector<int>::iterator sit = schedule.begin();
+	for ( ; sit != schedule.end(); sit++ )
+	{
+		ChainIterator pit = pendingAt[*sit - 1];
+		int window = windows.open( *sit, partners );
+		if ( window < 0 )
+		{
+			window = index.size();
+		}
+		int position = _bisectIndex( index, pit->first, window, NodeKey() );
+		ChainIterator before = chain.end();
+		if ( position < static_cast<int>( index.size() ) )
+		{
+			before = index[position];
+		}
+		chain.splice( before, pending, pit );
+		index.insert( position, pit );
+		windows.inserted( position );
+	}
+	elements.swap( chain );
+}
+
+template <typename Container, typename Compare>
+template <typename Entry, typename KeyOf>
+int PmergeMe<Container, Compare>::_bisectIndex( const BlockedChain<Entry> & chain,
+                                                const value_type & key, int window,
+                                                const KeyOf & keyOf )
+{
+	int lo = 0;
+	int hi = window;
+
+	while ( lo < hi )
+	{
+		int mid = ( lo + hi ) / 2;
+		size_t first;
+		size_t length;
+		const Entry * block = chain.block( mid, first, length );
+		// Once the range fits in one block, finish on contiguous memory
+		if ( first <= static_cast<size_t>( lo ) && static_cast<size_t>( hi ) <= first + length )
+		{
+			return ( lo + _bisectBlock( block + ( lo - first ), hi - lo, key, keyOf ) );
+		}
+		if ( _less( key, keyOf( block[mid - first] ) ) )
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid + 1;
+		}
+	}
+	return ( lo );
+}
+
+// Same probes as the loop above, with the branch turned into selects
+template <typename Container, typename Compare>
+template <typename Entry, typename KeyOf>
+int PmergeMe<Container, Compare>::_bisectBlock( const Entry * entries, int count,
+                                                const value_type & key, const KeyOf & keyOf )
+{
+	int lo = 0;
+
+	while ( count > 0 )
+	{
+		int step = count / 2;
+		bool right = !_less( key, keyOf( entries[lo + step] ) );
+		lo = right ? lo + step + 1 : lo;
+		count = right ? count - step - 1 : step;
+	}
+	return ( lo );
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef POOL_ALLOCATOR_HPP
+#define POOL_ALLOCATOR_HPP
+
+#include "NodeArena.hpp"
+#include <cstddef>
+
+/**
+ * @brief Standard allocator drawing from a NodeArena. Copies and rebound
+ *        copies share the arena and compare equal, so containers built from
+ *        the same arena can splice into each other. Without an arena it
+ *        falls back to the global heap.
+ */
+template <typename T>
+class PoolAllocator
+{
+	private:
+		NodeArena * _arena;
+
+	public:
+		typedef T value_type;
+		typedef T * pointer;
+		typedef const T * const_pointer;
+		typedef T & reference;
+		typedef const T & const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef PoolAllocator<U> other;
+		};
+
+		PoolAllocator( void );
+
+		/**
+		 * @brief Allocator drawing from arena, which must outlive every
+		 *        container using it
+		 */
+		PoolAllocator( NodeArena * arena );
+		PoolAllocator( const PoolAllocator & src );
+		template <typename U>
+		PoolAllocator( const PoolAllocator<U> & src );
+		~PoolAllocator( void );
+
+		/**
+		 * @brief Assignment operator
+		 * @param src Source object to assign from
+		 * @return Reference to this object
+		 */
+		PoolAllocator & operator=( const PoolAllocator & src );
+
+		pointer address( reference value ) const;
+		const_pointer address( const_reference value ) const;
+		pointer allocate( size_type count, const void * hint = 0 );
+
+		/**
+		 * @brief No-op for arena memory, which goes back all at once
+		 */
+		void deallocate( pointer p, size_type count );
+		size_type max_size( void ) const;
+		void construct( pointer p, const T & value );
+		void destroy( pointer p );
+
+		NodeArena * getArena( void ) const;
+};
+
+template <typename T, typename U>
+bool operator==( const PoolAllocator<T> & a, const PoolAllocator<U> & b );
+template <typename T, typename U>
+bool operator!=( const PoolAllocator<T> & a, const PoolAllocator<U> & b );
+
+#include "PoolAllocator.tpp"
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef POOL_ALLOCATOR_TPP
+#define POOL_ALLOCATOR_TPP
+
+#include <limits>
+#include <new>
+
+// Default constructor
+template <typename T>
+PoolAllocator<T>::PoolAllocator( void ) : _arena( 0 ) {}
+
+// Arena constructor
+template <typename T>
+PoolAllocator<T>::PoolAllocator( NodeArena * arena ) : _arena( arena ) {}
+
+// Copy constructor
+template <typename T>
+PoolAllocator<T>::PoolAllocator( const PoolAllocator & src ) : _arena( src._arena ) {}
+
+// Rebinding copy constructor
+template <typename T>
+template <typename U>
+PoolAllocator<T>::PoolAllocator( const PoolAllocator<U> & src ) : _arena( src.getArena() ) {}
+
+// Destructor
+template <typename T>
+PoolAllocator<T>::~PoolAllocator( void ) {}
+
+// Assignment operator
+template <typename T>
+PoolAllocator<T> & PoolAllocator<T>::operator=( const PoolAllocator & src )
+{
+	_arena = src._arena;
+	return ( *this );
+}
+
+template <typename T>
+typename PoolAllocator<T>::pointer PoolAllocator<T>::address( reference value ) const
+{
+	return ( &value );
+}
+
+template <typename T>
+typename PoolAllocator<T>::const_pointer
+PoolAllocator<T>::address( const_reference value ) const
+{
+	return ( &value );
+}
+
+template <typename T>
+typename PoolAllocator<T>::pointer PoolAllocator<T>::allocate( size_type count,
+                                                               const void * hint )
+{
+	( void )hint;
+	if ( count > max_size() )
+	{
+		throw ( std::bad_alloc() );
+	}
+	if ( _arena == 0 )
+	{
+		return ( static_cast<pointer>( ::operator new( count * sizeof( T ) ) ) );
+	}
+	return ( static_cast<pointer>( _arena->allocate( count * sizeof( T ), __alignof__( T ) ) ) );
+}
+
+template <typename T>
+void PoolAllocator<T>::deallocate( pointer p, size_type count )
+{
+	( void )count;
+	if ( _arena == 0 )
+	{
+		::operator delete( p );
+	}
+}
+
+template <typename T>
+typename PoolAllocator<T>::size_type PoolAllocator<T>::max_size( void ) const
+{
+	return ( std::numeric_limits<size_type>::max() / sizeof( T ) );
+}
+
+template <typename T>
+void PoolAllocator<T>::construct( pointer p, const T & value )
+{
+	new ( p ) T( value );
+}
+
+template <typename T>
+void PoolAllocator<T>::destroy( pointer p )
+{
+	p->~T();
+}
+
+template <typename T>
+NodeArena * PoolAllocator<T>::getArena( void ) const
+{
+	return ( _arena );
+}
+
+template <typename T, typename U>
+bool operator==( const PoolAllocator<T> & a, const PoolAllocator<U> & b )
+{
+	return ( a.getArena() == b.getArena() );
+}
+
+template <typename T, typename U>
+bool operator!=( const PoolAllocator<T> & a, const PoolAllocator<U> & b )
+{
+	return ( a.getArena() != b.getArena() );
+}
+
+#endif
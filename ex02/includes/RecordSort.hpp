@@ -0,0 +1,81 @@
+#ifndef RECORD_SORT_HPP
+#define RECORD_SORT_HPP
+
+#include "PmergeMe.hpp"
+#include <iterator>
+#include <vector>
+
+/**
+ * @brief Orders record indices by the records they name, so the engine
+ *        moves 4-byte indices while the comparator sees whole records
+ */
+template <typename RandomAccessIterator, typename Compare>
+class RecordOrder
+{
+	private:
+		RandomAccessIterator _records;
+		Compare _compare;
+
+	public:
+		RecordOrder( void );
+
+		/**
+		 * @param records First record, index 0
+		 * @param compare Strict weak ordering on the records
+		 */
+		RecordOrder( RandomAccessIterator records, const Compare & compare );
+		RecordOrder( const RecordOrder & src );
+		~RecordOrder( void );
+
+		/**
+		 * @brief Assignment operator
+		 * @param src Source object to assign from
+		 * @return Reference to this object
+		 */
+		RecordOrder & operator=( const RecordOrder & src );
+
+		bool operator()( int a, int b ) const;
+};
+
+/**
+ * @brief Rearranges records so that position i receives the record that
+ *        was at order[i], one copy per record plus one per cycle
+ * @param first First record
+ * @param order Permutation of [0, number of records)
+ */
+template <typename RandomAccessIterator>
+void applyPermutation( RandomAccessIterator first, const std::vector<int> & order );
+
+/**
+ * @brief Sorts records in place with Ford-Johnson, for comparators costly
+ *        enough that the comparison count dominates. Records are only
+ *        copied once, after the sort, to apply the permutation.
+ * @param compare Strict weak ordering on the records, called concurrently
+ *        when threads > 1
+ * @param threads Threads the sort may use
+ * @return Comparisons made
+ */
+template <typename RandomAccessIterator, typename Compare>
+unsigned long sortRecords( RandomAccessIterator first, RandomAccessIterator last,
+                           const Compare & compare, int threads = 1 );
+
+/**
+ * @brief Key/payload sort: sorts keys in place and moves payload[i] along
+ *        with keys[i]. Keys are compared with std::less<Key> in the
+ *        engine's key arrays, so the payload is never touched until the
+ *        permutation is applied. This is the generic engine, not a fast
+ *        path: only int keys have a vectorized pair kernel, and
+ *        Ford-Johnson's insertions cost more than std::sort on cheap keys;
+ *        it pays off when fewer comparisons matter more.
+ * @param keys One key per payload record
+ * @param payload First payload record
+ * @param threads Threads the sort may use
+ * @return Comparisons made
+ */
+template <typename Key, typename RandomAccessIterator>
+unsigned long sortByKey( std::vector<Key> & keys, RandomAccessIterator payload,
+                         int threads = 1 );
+
+#include "RecordSort.tpp"
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef RECORD_SORT_TPP
+#define RECORD_SORT_TPP
+
+// Default constructor
+template <typename RandomAccessIterator, typename Compare>
+RecordOrder<RandomAccessIterator, Compare>::RecordOrder( void ) : _records(), _compare() {}
+
+// Records constructor
+template <typename RandomAccessIterator, typename Compare>
+RecordOrder<RandomAccessIterator, Compare>::RecordOrder( RandomAccessIterator records,
+                                                         const Compare & compare )
+	: _records( records ), _compare( compare ) {}
+
+// Copy constructor
+template <typename RandomAccessIterator, typename Compare>
+RecordOrder<RandomAccessIterator, Compare>::RecordOrder( const RecordOrder & src )
+	: _records( src._records ), _compare( src._compare ) {}
+
+// Destructor
+template <typename RandomAccessIterator, typename Compare>
+RecordOrder<RandomAccessIterator, Compare>::~RecordOrder( void ) {}
+
+// Assignment operator
+template <typename RandomAccessIterator, typename Compare>
+RecordOrder<RandomAccessIterator, Compare> &
+RecordOrder<RandomAccessIterator, Compare>::operator=( const RecordOrder & src )
+{
+	if ( this != &src )
+	{
+		_records = src._records;
+		_compare = src._compare;
+	}
+	return ( *this );
+}
+
+template <typename RandomAccessIterator, typename Compare>
+bool RecordOrder<RandomAccessIterator, Compare>::operator()( int a, int b ) const
+{
+	return ( _compare( _records[a], _records[b] ) );
+}
+
+// Walks each cycle of the permutation once, carrying its first record
+template <typename RandomAccessIterator>
+void applyPermutation( RandomAccessIterator first, const std::vector<int> & order )
+{
+	typedef typename std::iterator_traits<RandomAccessIterator>::value_type Record;
+	std::vector<bool> placed( order.size(), false );
+
+	for ( size_t start = 0; start < order.size(); start++ )
+	{
+		if ( placed[start] )
+		{
+			continue ;
+		}
+		Record carried = first[start];
+		size_t position = start;
+		while ( static_cast<size_t>( order[position] ) != start )
+		{
+			first[position] = first[order[position]];
+			placed[position] = true;
+			position = order[position];
+		}
+		first[position] = carried;
+		placed[position] = true;
+	}
+}
+
+template <typename RandomAccessIterator, typename Compare>
+unsigned long sortRecords( RandomAccessIterator first, RandomAccessIterator last,
+                           const Compare & compare, int threads )
+{
+	typedef RecordOrder<RandomAccessIterator, Compare> Order;
+	std::vector<int> indices( last - first );
+	for ( size_t i = 0; i < indices.size(); i++ )
+	{
+		indices[i] = i;
+	}
+	PmergeMe< std::vector<int>, Order > sorter( indices.begin(), indices.end(),
+	                                            Order( first, compare ) );
+	sorter.setThreads( threads );
+	sorter.sort();
+	applyPermutation( first, sorter.getSequence() );
+	return ( sorter.getComparisons() );
+}
+
+template <typename Key, typename RandomAccessIterator>
+unsigned long sortByKey( std::vector<Key> & keys, RandomAccessIterator payload, int threads )
+{
+	PmergeMe< std::vector<Key> > sorter( keys.begin(), keys.end() );
+	sorter.setThreads( threads );
+	sorter.sort();
+	keys = sorter.getSequence();
+	applyPermutation( payload, sorter.getOrder() );
+	return ( sorter.getComparisons() );
+}
+
+#endif
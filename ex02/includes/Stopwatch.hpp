@@ -0,0 +1,44 @@
+#ifndef STOPWATCH_HPP
+#define STOPWATCH_HPP
+
+#include <ctime>
+
+/**
+ * @brief Measures one interval on two clocks: monotonic wall-clock time,
+ *        which the user waits for, and the CPU time of the whole process,
+ *        worker threads included. Both have nanosecond resolution, unlike
+ *        std::clock.
+ */
+class Stopwatch
+{
+	private:
+		struct timespec _wallStart;
+		struct timespec _cpuStart;
+		double _wall;
+		double _cpu;
+
+		static double _elapsed( const struct timespec & from, const struct timespec & to );
+
+	public:
+		Stopwatch( void );
+		Stopwatch( const Stopwatch & src );
+		~Stopwatch( void );
+
+		/**
+		 * @brief Assignment operator
+		 * @param src Source object to assign from
+		 * @return Reference to this object
+		 */
+		Stopwatch & operator=( const Stopwatch & src );
+
+		void start( void );
+		void stop( void );
+
+		/**
+		 * @return Milliseconds between the last start and stop
+		 */
+		double getWall( void ) const;
+		double getCpu( void ) const;
+};
+
+#endif
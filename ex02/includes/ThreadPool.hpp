@@ -0,0 +1,61 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * @brief Fixed set of pthread workers that split a task into chunks. Idle
+ *        workers claim the next unclaimed chunk, so a slow chunk never
+ *        holds the others back; the calling thread works as well.
+ */
+class ThreadPool
+{
+	public:
+		/**
+		 * @brief Work split into independent chunks
+		 */
+		class Task
+		{
+			public:
+				virtual ~Task( void ) {}
+				virtual void run( size_t chunk ) = 0;
+		};
+
+		/**
+		 * @brief Starts threads - 1 workers
+		 * @param threads Total threads, the caller included
+		 */
+		ThreadPool( int threads );
+		~ThreadPool( void );
+
+		int size( void ) const;
+
+		/**
+		 * @brief Runs every chunk of task and returns once all are done
+		 * @param task Task to run
+		 * @param chunks Number of chunks
+		 */
+		void run( Task & task, size_t chunks );
+
+	private:
+		std::vector<pthread_t> _workers;
+		pthread_mutex_t _mutex;
+		pthread_cond_t _wake;
+		pthread_cond_t _done;
+		Task * _task;
+		size_t _chunks;
+		size_t _next;
+		size_t _completed;
+		bool _stop;
+
+		ThreadPool( void );
+		ThreadPool( const ThreadPool & src );
+		ThreadPool & operator=( const ThreadPool & src );
+
+		static void * _work( void * pool );
+		void _claimChunks( void );
+};
+
+#endif
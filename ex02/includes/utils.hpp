@@ -4,6 +4,7 @@
 #define VERBOSE 0
 
 #include "Colors.h"
+#include "Stopwatch.hpp"
 #include <algorithm>
 #include <ctime>
 #include <cctype>
@@ -24,36 +25,74 @@
 #include <vector>
 
 void printLine( std::string color, std::string key, std::string value);
-std::string getContentsAsString( std::vector<int> & vector );
-std::string getContentsAsString( std::vector< std::pair<int, int> > & vector );
-std::string getContentsAsString( std::list<int> & list );
-std::string getContentsAsString( std::list< std::pair<int, int> > & list );
 
 template <typename T>
-void printContainer( std::vector<T> & vector, std::string name, std::string color )
+void putElement( std::ostream & os, const T & element )
+{
+	os << "[" << element << "]";
+}
+
+template <typename T, typename U>
+void putElement( std::ostream & os, const std::pair<T, U> & element )
+{
+	os << "[" << element.first << "--" << element.second << "]";
+}
+
+// Longer containers print only their first and last PRINT_EDGE elements
+static const size_t PRINT_EDGE = 8;
+
+template <typename Container>
+std::string getContentsAsString( const Container & container )
 {
 	std::stringstream ss;
-	ss << name << " vector (size " << vector.size() << "): ";
-	printLine( color, ss.str(), getContentsAsString( vector ) );
+	size_t size = container.size();
+	size_t i = 0;
+	typename Container::const_iterator it = container.begin();
+	for ( ; it != container.end(); it++, i++ )
+	{
+		if ( size <= 2 * PRINT_EDGE || i < PRINT_EDGE || i >= size - PRINT_EDGE )
+		{
+			putElement( ss, *it );
+		}
+		else if ( i == PRINT_EDGE )
+		{
+			ss << "[... " << size - 2 * PRINT_EDGE << " more ...]";
+		}
+	}
+	return ( ss.str() );
 }
 
-template <typename T>
-void printContainer( std::list<T> & list, std::string name, std::string color )
+template <typename Container>
+void printContainer( const Container & container, std::string name, std::string color )
 {
 	std::stringstream ss;
-	ss << "-- " << name << " list (size " << list.size() << "): ";
-	printLine( color, ss.str(), getContentsAsString( list ) );
+	ss << name << " (size " << container.size() << "): ";
+	printLine( color, ss.str(), getContentsAsString( container ) );
+}
+
+// Compiled out unless VERBOSE is set, so sort() timings carry no printing
+template <typename Container>
+void printVerbose( const Container & container, const char * name, const char * color )
+{
+#if VERBOSE
+	printContainer( container, name, color );
+#else
+	( void )container;
+	( void )name;
+	( void )color;
+#endif
 }
 
-int * getArrayToSort( int ac, char **av );
-int getNumber( char * nbStr, int * array, int array_size );
-bool isADuplicate( int * array, int array_size, int nb );
 template <typename T>
-void verifySortAccuracy( int * array, int array_size, T & resultContainer );
-std::vector<int> * convertArrayToVector( int * array, int array_size );
-void printTime(std::string containerType, std::clock_t time, int elements);
+void verifySortAccuracy( const std::vector<int> & expected, const T & resultContainer,
+                         std::string containerType );
+void printTime(std::string containerType, const Stopwatch & time, int elements);
+void printComparisons( unsigned long comparisons, int elements );
 void testPmergeMe( int ac, char **av );
-std::clock_t test_vector( int * array, int array_size);
-std::clock_t test_list( int * array, int array_size );
+void benchPmergeMe( int ac, char **av, int threads );
+void externalPmergeMe( int ac, char **av, int threads );
+template <typename Container>
+Stopwatch testContainer( const int * array, int array_size, const std::vector<int> & expected,
+                         std::string containerType, int threads );
 
 #endif
@@ -0,0 +1,845 @@
+#include "Benchmark.hpp"
+#include "ExternalSort.hpp"
+#include "InsertionSchedule.hpp"
+#include "PairKernels.hpp"
+#include "RecordSort.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <new>
+#include <sstream>
+#include <unistd.h>
+
+const unsigned int Benchmark::SEED;
+const size_t Benchmark::SMALL_BUDGET;
+
+// Set by make bench only, so the shipped PmergeMe keeps the library's
+// operator new and reports no allocation counts
+#ifndef PMERGEME_COUNT_ALLOCATIONS
+# define PMERGEME_COUNT_ALLOCATIONS 0
+#endif
+
+#if PMERGEME_COUNT_ALLOCATIONS
+
+// Every operator new in the program is counted, so the benchmark can report
+// allocations per sort. Atomic because pool workers may allocate too; kept
+// out of line, or GCC pairs the inlined free() with new and rejects it.
+static unsigned long allocations = 0;
+
+__attribute__(( noinline )) void * operator new( std::size_t size ) throw( std::bad_alloc )
+{
+	__sync_fetch_and_add( &allocations, 1 );
+	for ( ;; )
+	{
+		void * memory = std::malloc( size ? size : 1 );
+		if ( memory )
+		{
+			return ( memory );
+		}
+		// C++98 has no get_new_handler(): read it by swapping it out and back
+		std::new_handler handler = std::set_new_handler( 0 );
+		std::set_new_handler( handler );
+		if ( !handler )
+		{
+			throw ( std::bad_alloc() );
+		}
+		handler();
+	}
+}
+
+__attribute__(( noinline )) void operator delete( void * memory ) throw()
+{
+	std::free( memory );
+}
+
+#endif
+
+// Counts the comparisons of the std baselines, in a pass outside the timing
+class CountingLess
+{
+	private:
+		unsigned long * _count;
+
+	public:
+		CountingLess( unsigned long * count ) : _count( count ) {}
+
+		bool operator()( int a, int b ) const
+		{
+			( *_count )++;
+			return ( a < b );
+		}
+};
+
+/*
+ * Orders records by the low half of their key after 64 rounds of
+ * xorshift, a bijection, standing in for a costly comparison such as
+ * locale collation. Counts
+ * when given a counter; sortRecords() may call it from several threads.
+ */
+template <typename Record>
+class CostlyLess
+{
+	private:
+		unsigned long * _count;
+
+		static uint32_t _collate( int64_t key )
+		{
+			uint32_t state = static_cast<uint32_t>( key );
+			for ( int round = 0; round < 64; round++ )
+			{
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+			}
+			return ( state );
+		}
+
+	public:
+		CostlyLess( unsigned long * count ) : _count( count ) {}
+
+		bool operator()( const Record & a, const Record & b ) const
+		{
+			if ( _count != 0 )
+			{
+				( *_count )++;
+			}
+			return ( _collate( a.key ) < _collate( b.key ) );
+		}
+};
+
+// Plain key ordering, the std counterpart of sortByKey()
+template <typename Record>
+class KeyLess
+{
+	private:
+		unsigned long * _count;
+
+	public:
+		KeyLess( unsigned long * count ) : _count( count ) {}
+
+		bool operator()( const Record & a, const Record & b ) const
+		{
+			if ( _count != 0 )
+			{
+				( *_count )++;
+			}
+			return ( a.key < b.key );
+		}
+};
+
+// Creates an empty file in directory that no other run will pick
+static std::string temporaryFile( const std::string & directory )
+{
+	std::string pattern = directory + "/PmergeMe-bench-XXXXXX";
+	std::vector<char> path( pattern.begin(), pattern.end() );
+	path.push_back( '\0' );
+	int fd = mkstemp( &path[0] );
+	if ( fd < 0 )
+	{
+		throw ( std::runtime_error( directory + ": " + std::strerror( errno ) ) );
+	}
+	close( fd );
+	return ( &path[0] );
+}
+
+// Xorshift32: portable, unlike std::rand, so seeds reproduce everywhere
+static unsigned int nextRandom( unsigned int & state )
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return ( state );
+}
+
+// Default constructor
+Benchmark::Benchmark( void )
+	: _elements( 0 ), _trials( 0 ), _warmup( 0 ), _threads( 1 ), _externalBudget( 0 ),
+	  _externalTimes( 0 ) {}
+
+// Settings constructor
+Benchmark::Benchmark( size_t elements, int trials, int warmup, int threads )
+	: _elements( elements ), _trials( trials ), _warmup( warmup ), _threads( threads ),
+	  _externalBudget( 0 ), _externalTimes( 0 ) {}
+
+// Copy constructor
+Benchmark::Benchmark( const Benchmark & src )
+	: _elements( src._elements ), _trials( src._trials ), _warmup( src._warmup ),
+	  _threads( src._threads ), _externalBudget( src._externalBudget ),
+	  _externalTimes( src._externalTimes ), _directory( src._directory ),
+	  _results( src._results ) {}
+
+// Destructor
+Benchmark::~Benchmark( void ) {}
+
+// Assignment operator
+Benchmark & Benchmark::operator=( const Benchmark & src )
+{
+	if ( this != &src )
+	{
+		_elements = src._elements;
+		_trials = src._trials;
+		_warmup = src._warmup;
+		_threads = src._threads;
+		_externalBudget = src._externalBudget;
+		_externalTimes = src._externalTimes;
+		_directory = src._directory;
+		_results = src._results;
+	}
+	return ( *this );
+}
+
+void Benchmark::setExternal( size_t budget, int times, const std::string & directory )
+{
+	_externalBudget = budget;
+	_externalTimes = times;
+	_directory = directory;
+}
+
+std::vector<int> Benchmark::generate( Distribution distribution, size_t elements,
+                                      unsigned int seed )
+{
+	std::vector<int> values( elements );
+	unsigned int state = seed == 0 ? 1 : seed;
+	// Sixteen ascending teeth
+	size_t period = elements / 16 + 1;
+	for ( size_t i = 0; i < elements; i++ )
+	{
+		switch ( distribution )
+		{
+			case REVERSED:
+				values[i] = elements - i;
+				break ;
+			case FEW_UNIQUE:
+				values[i] = nextRandom( state ) % 16 + 1;
+				break ;
+			case SAWTOOTH:
+				values[i] = i % period + 1;
+				break ;
+			default:
+				values[i] = i + 1;
+		}
+	}
+	if ( distribution == RANDOM )
+	{
+		for ( size_t i = elements; i > 1; i-- )
+		{
+			std::swap( values[i - 1], values[nextRandom( state ) % i] );
+		}
+	}
+	else if ( ( distribution == NEARLY_SORTED || distribution == SWAPPED ) && elements > 1 )
+	{
+		size_t swaps = elements / ( distribution == NEARLY_SORTED ? 1000 : 100 ) + 1;
+		for ( size_t s = 0; s < swaps; s++ )
+		{
+			size_t i = nextRandom( state ) % elements;
+			std::swap( values[i], values[nextRandom( state ) % elements] );
+		}
+	}
+	else if ( distribution == SORTED_TAIL )
+	{
+		for ( size_t i = elements - elements / 100; i < elements; i++ )
+		{
+			values[i] = nextRandom( state ) % elements + 1;
+		}
+	}
+	return ( values );
+}
+
+const char * Benchmark::getName( Distribution distribution )
+{
+	static const char * names[DISTRIBUTIONS] = { "random", "sorted", "reversed",
+	                                             "few-unique", "sawtooth", "nearly-sorted",
+	                                             "swapped-1%", "sorted+tail" };
+	return ( names[distribution] );
+}
+
+void Benchmark::run( void )
+{
+	static const char * sorters[] = { "PmergeMe vector", "PmergeMe deque", "PmergeMe list",
+	                                  "std::sort", "std::stable_sort" };
+	_results.clear();
+	for ( int d = 0; d < DISTRIBUTIONS; d++ )
+	{
+		std::vector<int> input = generate( static_cast<Distribution>( d ), _elements, SEED );
+		std::vector<int> expected( input );
+		std::sort( expected.begin(), expected.end() );
+		for ( int s = 0; s < 5; s++ )
+		{
+			Result result( getName( static_cast<Distribution>( d ) ), sorters[s] );
+			if ( s == 0 )
+			{
+				_measurePmergeMe< std::vector<int> >( input, expected, _threads, true, true, result );
+			}
+			else if ( s == 1 )
+			{
+				_measurePmergeMe< std::deque<int> >( input, expected, _threads, true, true, result );
+			}
+			else if ( s == 2 )
+			{
+				_measurePmergeMe< std::list<int> >( input, expected, _threads, true, true, result );
+			}
+			else
+			{
+				_measureStd( input, expected, s == 4, result );
+			}
+			_results.push_back( result );
+		}
+	}
+	if ( _threads > 1 )
+	{
+		_runScaling();
+	}
+	_runRecords();
+	_runKernels();
+	_runAllocators();
+	_runAdaptive();
+	Result schedule( "schedule", "buildInsertionSchedule" );
+	_measureSchedule( schedule );
+	_results.push_back( schedule );
+	if ( _externalBudget > 0 )
+	{
+		_runExternal();
+	}
+}
+
+// Per-thread rows on the random input; threads only change who pairs
+void Benchmark::_runScaling( void )
+{
+	std::vector<int> input = generate( RANDOM, _elements, SEED );
+	std::vector<int> expected( input );
+	std::sort( expected.begin(), expected.end() );
+	unsigned long comparisons = 0;
+	for ( int threads = 1; threads <= _threads; threads++ )
+	{
+		std::stringstream sorter;
+		sorter << "vector, " << threads << ( threads == 1 ? " thread" : " threads" );
+		Result result( "scaling", sorter.str() );
+		_measurePmergeMe< std::vector<int> >( input, expected, threads, true, true, result );
+		if ( threads > 1 && result.comparisons != comparisons )
+		{
+			throw ( std::runtime_error( result.sorter + " changed the comparison count" ) );
+		}
+		comparisons = result.comparisons;
+		_results.push_back( result );
+	}
+}
+
+/*
+ * Pair formation of the random input by each kernel this CPU runs. The
+ * dispatcher picks the widest, and every narrower one runs too, so its
+ * name tells which rows to add. Each output is checked against scalar.
+ */
+void Benchmark::_runKernels( void )
+{
+	static const char * names[] = { "scalar", "sse4.1", "avx2" };
+	static const PairKernel kernels[] = { &pairIntScalar, &pairIntSse41, &pairIntAvx2 };
+	const char * widest = 0;
+	selectPairKernel( &widest );
+	std::vector<int> keys = generate( RANDOM, _elements, SEED );
+	size_t pairs = keys.size() / 2;
+	std::vector<int> smaller( pairs + 1 );
+	std::vector<int> larger( pairs + 1 );
+	std::vector<int> largerKeys( pairs + 1 );
+	std::vector<int> reference;
+	for ( int k = 0; k < 3; k++ )
+	{
+		bool dispatched = std::strcmp( names[k], widest ) == 0;
+		Result result( "pairing",
+		               std::string( names[k] ) + ( dispatched ? " (dispatched)" : "" ) );
+		result.comparisons = pairs;
+		Stopwatch stopwatch;
+		for ( int trial = 0; trial < _warmup + _trials; trial++ )
+		{
+			stopwatch.start();
+			kernels[k]( &keys[0], &smaller[0], &larger[0], &largerKeys[0], 0, pairs );
+			stopwatch.stop();
+			if ( trial >= _warmup )
+			{
+				result.wall.push_back( stopwatch.getWall() );
+				result.cpu.push_back( stopwatch.getCpu() );
+			}
+		}
+		std::vector<int> output( smaller );
+		output.insert( output.end(), larger.begin(), larger.end() );
+		output.insert( output.end(), largerKeys.begin(), largerKeys.end() );
+		if ( k == 0 )
+		{
+			reference.swap( output );
+		}
+		else if ( output != reference )
+		{
+			throw ( std::runtime_error( result.sorter + " kernel paired incorrectly" ) );
+		}
+		_results.push_back( result );
+		if ( dispatched )
+		{
+			break ;
+		}
+	}
+}
+
+// The random input as records with signed 64-bit keys, sorted by the
+// costly ordering, then by the plain key
+void Benchmark::_runRecords( void )
+{
+	static const char * sorters[] = { "sortRecords", "std::sort", "std::stable_sort",
+	                                  "sortByKey", "std::sort", "std::stable_sort" };
+	std::vector<int> values = generate( RANDOM, _elements, SEED );
+	std::vector<Record> input( values.size() );
+	for ( size_t i = 0; i < values.size(); i++ )
+	{
+		// Times 2^32 + 15: spans both halves, and the low half alone stays
+		// distinct up to 2^28 elements
+		int64_t centered = static_cast<int64_t>( values[i] )
+		                   - static_cast<int64_t>( _elements / 2 );
+		input[i].key = centered * ( ( static_cast<int64_t>( 1 ) << 32 ) + 15 );
+		std::fill( input[i].payload, input[i].payload + 14, values[i] );
+	}
+	for ( int byKey = 0; byKey < 2; byKey++ )
+	{
+		std::vector<Record> expected( input );
+		if ( byKey )
+		{
+			std::stable_sort( expected.begin(), expected.end(), KeyLess<Record>( 0 ) );
+		}
+		else
+		{
+			std::stable_sort( expected.begin(), expected.end(), CostlyLess<Record>( 0 ) );
+		}
+		for ( int s = 0; s < 3; s++ )
+		{
+			Result result( byKey ? "int64 keys" : "records", sorters[3 * byKey + s] );
+			_measureRecords( input, expected, static_cast<RecordSorter>( s ), byKey, result );
+			_results.push_back( result );
+		}
+	}
+}
+
+// Copies the input before every trial, outside the timing; the std sorters
+// count their comparisons in one extra untimed pass
+void Benchmark::_measureRecords( const std::vector<Record> & input,
+                                 const std::vector<Record> & expected, RecordSorter sorter,
+                                 bool byKey, Result & result ) const
+{
+	std::vector<Record> records;
+	std::vector<int64_t> keys;
+	Stopwatch stopwatch;
+	for ( int trial = -1; trial < _warmup + _trials; trial++ )
+	{
+		unsigned long * count = trial < 0 ? &result.comparisons : 0;
+		if ( trial < 0 && sorter == PMERGEME )
+		{
+			continue ;
+		}
+		records = input;
+		keys.resize( records.size() );
+		for ( size_t i = 0; i < records.size(); i++ )
+		{
+			keys[i] = records[i].key;
+		}
+		unsigned long allocations = _allocations();
+		stopwatch.start();
+		if ( sorter == PMERGEME && byKey )
+		{
+			result.comparisons = sortByKey( keys, records.begin(), _threads );
+		}
+		else if ( sorter == PMERGEME )
+		{
+			result.comparisons = sortRecords( records.begin(), records.end(),
+			                                  CostlyLess<Record>( 0 ), _threads );
+		}
+		else if ( sorter == STD_SORT && byKey )
+		{
+			std::sort( records.begin(), records.end(), KeyLess<Record>( count ) );
+		}
+		else if ( sorter == STD_SORT )
+		{
+			std::sort( records.begin(), records.end(), CostlyLess<Record>( count ) );
+		}
+		else if ( byKey )
+		{
+			std::stable_sort( records.begin(), records.end(), KeyLess<Record>( count ) );
+		}
+		else
+		{
+			std::stable_sort( records.begin(), records.end(), CostlyLess<Record>( count ) );
+		}
+		stopwatch.stop();
+		if ( trial < 0 )
+		{
+			continue ;
+		}
+		if ( trial == 0 )
+		{
+			result.allocations = _allocations() - allocations;
+			for ( size_t i = 0; i < records.size(); i++ )
+			{
+				if ( records[i].key != expected[i].key
+				     || records[i].payload[13] != expected[i].payload[13] )
+				{
+					throw ( std::runtime_error( result.sorter + " sorted " + result.distribution
+					                            + " incorrectly" ) );
+				}
+			}
+		}
+		if ( trial >= _warmup )
+		{
+			result.wall.push_back( stopwatch.getWall() );
+			result.cpu.push_back( stopwatch.getCpu() );
+		}
+	}
+}
+
+// The check holds the whole input in memory; only ExternalSort keeps to
+// the budget
+void Benchmark::_runExternal( void )
+{
+	size_t elements = _externalBudget / sizeof( int ) * _externalTimes;
+	std::vector<int> values = generate( RANDOM, elements, SEED );
+	std::string input = temporaryFile( _directory );
+	std::string output;
+	try
+	{
+		output = temporaryFile( _directory );
+		std::ofstream file( input.c_str(), std::ios::binary );
+		file.write( reinterpret_cast<const char *>( &values[0] ), elements * sizeof( int ) );
+		file.close();
+		if ( !file )
+		{
+			throw ( std::runtime_error( input + ": write error" ) );
+		}
+		std::sort( values.begin(), values.end() );
+		size_t budgets[] = { _externalBudget, SMALL_BUDGET };
+		for ( int b = 0; b < 2; b++ )
+		{
+			std::stringstream sorter;
+			sorter << budgets[b] / 1024 << " KiB, input "
+				<< elements * sizeof( int ) / budgets[b] << "x";
+			Result result( "external", sorter.str() );
+			_measureExternal( input, output, values, budgets[b], result );
+			_results.push_back( result );
+		}
+	}
+	catch ( ... )
+	{
+		unlink( input.c_str() );
+		if ( !output.empty() )
+		{
+			unlink( output.c_str() );
+		}
+		throw ;
+	}
+	unlink( input.c_str() );
+	unlink( output.c_str() );
+}
+
+/*
+ * A fresh sorter per trial; the first trial's output is read back and
+ * compared with std::sort. Under SMALL_BUDGET each merge takes 3 runs, so
+ * the reported passes must be those of merging groups of 3 until 3 are left.
+ */
+void Benchmark::_measureExternal( const std::string & input, const std::string & output,
+                                  const std::vector<int> & expected, size_t budget,
+                                  Result & result ) const
+{
+	Stopwatch stopwatch;
+	for ( int trial = 0; trial < _warmup + _trials; trial++ )
+	{
+		ExternalSort sorter( budget, _threads, _directory );
+		unsigned long allocations = _allocations();
+		stopwatch.start();
+		sorter.sort( input, output );
+		stopwatch.stop();
+		if ( trial == 0 )
+		{
+			result.allocations = _allocations() - allocations;
+			result.comparisons = sorter.getComparisons();
+			result.runs = sorter.getRuns();
+			result.passes = sorter.getPasses();
+			std::vector<int> sorted( expected.size() + 1 );
+			std::ifstream file( output.c_str(), std::ios::binary );
+			file.read( reinterpret_cast<char *>( &sorted[0] ), sorted.size() * sizeof( int ) );
+			if ( static_cast<size_t>( file.gcount() ) != expected.size() * sizeof( int )
+			     || !std::equal( expected.begin(), expected.end(), sorted.begin() ) )
+			{
+				throw ( std::runtime_error( "external sort with " + result.sorter
+				                            + " sorted incorrectly" ) );
+			}
+			if ( budget == SMALL_BUDGET )
+			{
+				size_t passes = 1;
+				for ( size_t runs = result.runs; runs > 3; runs = ( runs + 2 ) / 3 )
+				{
+					passes++;
+				}
+				if ( result.passes != passes )
+				{
+					throw ( std::runtime_error( "external sort with " + result.sorter
+					                            + " reported the wrong number of passes" ) );
+				}
+			}
+		}
+		if ( trial >= _warmup )
+		{
+			result.wall.push_back( stopwatch.getWall() );
+			result.cpu.push_back( stopwatch.getCpu() );
+		}
+	}
+}
+
+// PmergeMe list on the random input, nodes from the arena then the heap
+void Benchmark::_runAllocators( void )
+{
+	static const char * sorters[] = { "list, node arena", "list, global heap" };
+	std::vector<int> input = generate( RANDOM, _elements, SEED );
+	std::vector<int> expected( input );
+	std::sort( expected.begin(), expected.end() );
+	for ( int a = 0; a < 2; a++ )
+	{
+		Result result( "allocator", sorters[a] );
+		_measurePmergeMe< std::list<int> >( input, expected, _threads, a == 0, true, result );
+		_results.push_back( result );
+	}
+}
+
+/*
+ * PmergeMe vector on presorted inputs, with the sorted check and run scan
+ * and then without, where the whole input goes through Ford-Johnson
+ */
+void Benchmark::_runAdaptive( void )
+{
+	static const Distribution inputs[] = { SORTED, NEARLY_SORTED, SWAPPED, SORTED_TAIL,
+	                                       REVERSED };
+	for ( size_t d = 0; d < sizeof( inputs ) / sizeof( inputs[0] ); d++ )
+	{
+		std::vector<int> input = generate( inputs[d], _elements, SEED );
+		std::vector<int> expected( input );
+		std::sort( expected.begin(), expected.end() );
+		for ( int a = 0; a < 2; a++ )
+		{
+			Result result( getName( inputs[d] ),
+			               a == 0 ? "vector, adaptive" : "vector, non-adaptive" );
+			_measurePmergeMe< std::vector<int> >( input, expected, _threads, true, a == 0,
+			                                      result );
+			_results.push_back( result );
+		}
+	}
+}
+
+void Benchmark::_measureStd( const std::vector<int> & input, const std::vector<int> & expected,
+                             bool stable, Result & result ) const
+{
+	std::vector<int> values( input );
+	if ( stable )
+	{
+		std::stable_sort( values.begin(), values.end(), CountingLess( &result.comparisons ) );
+	}
+	else
+	{
+		std::sort( values.begin(), values.end(), CountingLess( &result.comparisons ) );
+	}
+	if ( values != expected )
+	{
+		throw ( std::runtime_error( result.sorter + " sorted " + result.distribution +
+		                            " input incorrectly" ) );
+	}
+	Stopwatch stopwatch;
+	for ( int trial = 0; trial < _warmup + _trials; trial++ )
+	{
+		values = input;
+		unsigned long allocations = _allocations();
+		stopwatch.start();
+		if ( stable )
+		{
+			std::stable_sort( values.begin(), values.end() );
+		}
+		else
+		{
+			std::sort( values.begin(), values.end() );
+		}
+		stopwatch.stop();
+		if ( trial == 0 )
+		{
+			result.allocations = _allocations() - allocations;
+		}
+		if ( trial >= _warmup )
+		{
+			result.wall.push_back( stopwatch.getWall() );
+			result.cpu.push_back( stopwatch.getCpu() );
+		}
+	}
+}
+
+// Builds the schedule of every recursion level of a sort of _elements, each
+// into a fresh vector as the sorter does, halving the items per level
+void Benchmark::_measureSchedule( Result & result ) const
+{
+	Stopwatch stopwatch;
+	for ( int trial = 0; trial < _warmup + _trials; trial++ )
+	{
+		size_t scheduled = 0;
+		unsigned long allocations = _allocations();
+		stopwatch.start();
+		for ( size_t items = _elements; items > 1; items /= 2 )
+		{
+			std::vector<int> schedule;
+			buildInsertionSchedule( ( items + 1 ) / 2, schedule );
+			scheduled += schedule.size();
+		}
+		stopwatch.stop();
+		if ( trial == 0 )
+		{
+			result.allocations = _allocations() - allocations;
+		}
+		if ( trial >= _warmup )
+		{
+			result.wall.push_back( stopwatch.getWall() );
+			result.cpu.push_back( stopwatch.getCpu() );
+		}
+		if ( scheduled < _elements / 2 )
+		{
+			throw ( std::runtime_error( result.sorter + " produced a short schedule" ) );
+		}
+	}
+}
+
+unsigned long Benchmark::_allocations( void )
+{
+#if PMERGEME_COUNT_ALLOCATIONS
+	return ( __sync_fetch_and_add( &allocations, 0 ) );
+#else
+	return ( 0 );
+#endif
+}
+
+// Interpolates between the two nearest order statistics
+double Benchmark::_percentile( std::vector<double> samples, double fraction )
+{
+	if ( samples.empty() )
+	{
+		return ( 0 );
+	}
+	std::sort( samples.begin(), samples.end() );
+	double rank = fraction * ( samples.size() - 1 );
+	size_t below = static_cast<size_t>( rank );
+	if ( below + 1 >= samples.size() )
+	{
+		return ( samples.back() );
+	}
+	return ( samples[below] + ( rank - below ) * ( samples[below + 1] - samples[below] ) );
+}
+
+void Benchmark::print( std::ostream & os ) const
+{
+	std::ios_base::fmtflags flags = os.flags();
+	std::streamsize precision = os.precision();
+	os << std::fixed << std::setprecision( 3 );
+	os << "Elements: " << _elements << ", trials: " << _trials << " ( + " << _warmup
+		<< " warmup ), threads: " << _threads << ", times in ms" << std::endl;
+	os << std::left << std::setw( 14 ) << "input" << std::setw( 24 ) << "sorter"
+		<< std::right << std::setw( 12 ) << "wall p50" << std::setw( 12 ) << "wall p10"
+		<< std::setw( 12 ) << "wall p90" << std::setw( 12 ) << "cpu p50"
+		<< std::setw( 14 ) << "comparisons" << std::setw( 10 ) << "allocs" << std::endl;
+	for ( size_t i = 0; i < _results.size(); i++ )
+	{
+		const Result & result = _results[i];
+		os << std::left << std::setw( 14 ) << result.distribution << std::setw( 24 )
+			<< result.sorter << std::right
+			<< std::setw( 12 ) << _percentile( result.wall, 0.5 )
+			<< std::setw( 12 ) << _percentile( result.wall, 0.1 )
+			<< std::setw( 12 ) << _percentile( result.wall, 0.9 )
+			<< std::setw( 12 ) << _percentile( result.cpu, 0.5 )
+			<< std::setw( 14 ) << result.comparisons << std::setw( 10 );
+		if ( PMERGEME_COUNT_ALLOCATIONS )
+		{
+			os << result.allocations;
+		}
+		else
+		{
+			os << "-";
+		}
+		if ( result.arenaBytes > 0 )
+		{
+			os << "  ( arena: " << result.arenaAllocations << " nodes in "
+				<< result.arenaBytes / 1024 << " KiB )";
+		}
+		if ( result.runs > 0 )
+		{
+			os << "  ( " << result.runs << " runs, " << result.passes << " merge passes )";
+		}
+		os << std::endl;
+	}
+	os.flags( flags );
+	os.precision( precision );
+}
+
+void Benchmark::_writeStatistics( std::ostream & os, const std::vector<double> & samples )
+{
+	os << "{ \"min\": " << _percentile( samples, 0 )
+		<< ", \"p10\": " << _percentile( samples, 0.1 )
+		<< ", \"median\": " << _percentile( samples, 0.5 )
+		<< ", \"p90\": " << _percentile( samples, 0.9 )
+		<< ", \"max\": " << _percentile( samples, 1 ) << " }";
+}
+
+void Benchmark::_writeSamples( std::ostream & os, const std::vector<double> & samples )
+{
+	os << "[";
+	for ( size_t i = 0; i < samples.size(); i++ )
+	{
+		os << ( i == 0 ? "" : ", " ) << samples[i];
+	}
+	os << "]";
+}
+
+void Benchmark::writeJson( std::ostream & os ) const
+{
+	std::ios_base::fmtflags flags = os.flags();
+	std::streamsize precision = os.precision();
+	os << std::fixed << std::setprecision( 6 );
+	os << "{" << std::endl
+		<< "  \"elements\": " << _elements << "," << std::endl
+		<< "  \"trials\": " << _trials << "," << std::endl
+		<< "  \"warmup\": " << _warmup << "," << std::endl
+		<< "  \"threads\": " << _threads << "," << std::endl
+		<< "  \"seed\": " << SEED << "," << std::endl
+		<< "  \"unit\": \"ms\"," << std::endl
+		<< "  \"results\": [" << std::endl;
+	for ( size_t i = 0; i < _results.size(); i++ )
+	{
+		const Result & result = _results[i];
+		os << "    {" << std::endl
+			<< "      \"distribution\": \"" << result.distribution << "\"," << std::endl
+			<< "      \"sorter\": \"" << result.sorter << "\"," << std::endl
+			<< "      \"comparisons\": " << result.comparisons << "," << std::endl
+			<< "      \"allocations\": ";
+		if ( PMERGEME_COUNT_ALLOCATIONS )
+		{
+			os << result.allocations;
+		}
+		else
+		{
+			os << "null";
+		}
+		os << "," << std::endl
+			<< "      \"arena_allocations\": " << result.arenaAllocations << "," << std::endl
+			<< "      \"arena_reserved_bytes\": " << result.arenaBytes << "," << std::endl
+			<< "      \"runs\": " << result.runs << "," << std::endl
+			<< "      \"passes\": " << result.passes << "," << std::endl
+			<< "      \"wall\": ";
+		_writeStatistics( os, result.wall );
+		os << "," << std::endl << "      \"cpu\": ";
+		_writeStatistics( os, result.cpu );
+		os << "," << std::endl << "      \"wall_samples\": ";
+		_writeSamples( os, result.wall );
+		os << "," << std::endl << "      \"cpu_samples\": ";
+		_writeSamples( os, result.cpu );
+		os << std::endl << "    }" << ( i + 1 < _results.size() ? "," : "" ) << std::endl;
+	}
+	os << "  ]" << std::endl << "}" << std::endl;
+	os.flags( flags );
+	os.precision( precision );
+}
@@ -0,0 +1,357 @@
+#include "ExternalSort.hpp"
+#include "LoserTree.hpp"
+#include "PmergeMe.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t ExternalSort::BYTES_PER_ELEMENT;
+const size_t ExternalSort::MIN_BUFFER;
+const size_t ExternalSort::MAX_WAYS;
+
+// Buffered read side of one run during a merge
+struct RunInput
+{
+	std::FILE * file;
+	std::vector<int> buffer;
+	size_t position;
+	size_t count;
+};
+
+static void throwError( const std::string & name )
+{
+	throw ( std::runtime_error( name + ": " + std::strerror( errno ) ) );
+}
+
+// Reads up to count integers; fewer means the end of the file
+static size_t readValues( std::FILE * file, int * values, size_t count, const std::string & name )
+{
+	size_t bytes = std::fread( values, 1, count * sizeof( int ), file );
+	if ( std::ferror( file ) )
+	{
+		throw ( std::runtime_error( name + ": read error" ) );
+	}
+	if ( bytes % sizeof( int ) != 0 )
+	{
+		throw ( std::runtime_error( name + ": size is not a whole number of 32-bit integers" ) );
+	}
+	return ( bytes / sizeof( int ) );
+}
+
+static void writeValues( std::FILE * file, const int * values, size_t count,
+                         const std::string & name )
+{
+	if ( count > 0 && std::fwrite( values, sizeof( int ), count, file ) != count )
+	{
+		throw ( std::runtime_error( name + ": write error" ) );
+	}
+}
+
+// Closing flushes the stdio buffer, so a full disk may only show up here
+static void closeWritten( std::FILE * file, const std::string & name )
+{
+	if ( std::fclose( file ) != 0 )
+	{
+		throwError( name );
+	}
+}
+
+static void refill( RunInput & run, const std::string & name )
+{
+	run.count = readValues( run.file, &run.buffer[0], run.buffer.size(), name );
+	run.position = 0;
+}
+
+// Default constructor
+ExternalSort::ExternalSort( void )
+	: _budget( 64 << 20 ), _threads( 1 ), _directory( "/tmp" ), _elements( 0 ), _runCount( 0 ),
+	  _passes( 0 ), _comparisons( 0 ) {}
+
+// Settings constructor
+ExternalSort::ExternalSort( size_t budget, int threads, const std::string & directory )
+	: _budget( budget ), _threads( threads ), _directory( directory ), _elements( 0 ),
+	  _runCount( 0 ), _passes( 0 ), _comparisons( 0 ) {}
+
+// Destructor
+ExternalSort::~ExternalSort( void )
+{
+	for ( size_t i = 0; i < _runs.size(); i++ )
+	{
+		unlink( _runs[i].c_str() );
+	}
+}
+
+void ExternalSort::sort( const std::string & input, const std::string & output )
+{
+	_elements = 0;
+	_runCount = 0;
+	_passes = 0;
+	_comparisons = 0;
+	std::string inputName = input == "-" ? "stdin" : input;
+	std::string outputName = output == "-" ? "stdout" : output;
+	std::FILE * in = input == "-" ? stdin : std::fopen( input.c_str(), "rb" );
+	if ( in == 0 )
+	{
+		throwError( inputName );
+	}
+	// Opening the output truncates it, so it must not be the input itself
+	struct stat inputStat;
+	struct stat outputStat;
+	if ( output != "-" && stat( output.c_str(), &outputStat ) == 0
+	     && fstat( fileno( in ), &inputStat ) == 0 && inputStat.st_dev == outputStat.st_dev
+	     && inputStat.st_ino == outputStat.st_ino )
+	{
+		if ( in != stdin )
+		{
+			std::fclose( in );
+		}
+		throw ( std::invalid_argument( outputName + ": output is the input file" ) );
+	}
+	std::FILE * out = output == "-" ? stdout : std::fopen( output.c_str(), "wb" );
+	if ( out == 0 )
+	{
+		int error = errno;
+		if ( in != stdin )
+		{
+			std::fclose( in );
+		}
+		errno = error;
+		throwError( outputName );
+	}
+	try
+	{
+		_formRuns( in, inputName, out, outputName );
+		std::vector<std::string> runs( _runs );
+		size_t ways = std::min( std::max( _budget / MIN_BUFFER, static_cast<size_t>( 3 ) ) - 1,
+		                        MAX_WAYS );
+		// Each pass merges groups of ways runs, until one final merge is left
+		while ( runs.size() > ways )
+		{
+			std::vector<std::string> merged;
+			for ( size_t first = 0; first < runs.size(); first += ways )
+			{
+				std::vector<std::string> group( runs.begin() + first,
+				                                runs.begin() + std::min( first + ways, runs.size() ) );
+				if ( group.size() == 1 )
+				{
+					merged.push_back( group[0] );
+					continue ;
+				}
+				std::FILE * file;
+				merged.push_back( _createRun( &file ) );
+				try
+				{
+					_merge( group, file, merged.back() );
+				}
+				catch ( ... )
+				{
+					std::fclose( file );
+					throw ;
+				}
+				closeWritten( file, merged.back() );
+				for ( size_t i = 0; i < group.size(); i++ )
+				{
+					_removeRun( group[i] );
+				}
+			}
+			runs.swap( merged );
+			_passes++;
+		}
+		if ( !runs.empty() )
+		{
+			_merge( runs, out, outputName );
+			_passes++;
+			for ( size_t i = 0; i < runs.size(); i++ )
+			{
+				_removeRun( runs[i] );
+			}
+		}
+	}
+	catch ( ... )
+	{
+		if ( in != stdin )
+		{
+			std::fclose( in );
+		}
+		if ( out != stdout )
+		{
+			std::fclose( out );
+		}
+		throw ;
+	}
+	if ( in != stdin )
+	{
+		std::fclose( in );
+	}
+	if ( out != stdout )
+	{
+		closeWritten( out, outputName );
+	}
+	else if ( std::fflush( out ) != 0 )
+	{
+		throwError( outputName );
+	}
+}
+
+// An input that fits in one chunk goes straight to output, with no run
+void ExternalSort::_formRuns( std::FILE * input, const std::string & name, std::FILE * output,
+                              const std::string & outputName )
+{
+	size_t chunk = std::max( _budget / BYTES_PER_ELEMENT, static_cast<size_t>( 1 ) );
+	std::vector<int> values( chunk );
+	while ( true )
+	{
+		size_t count = readValues( input, &values[0], chunk, name );
+		if ( count == 0 )
+		{
+			return ;
+		}
+		PmergeMe< std::vector<int> > sorter( values.begin(), values.begin() + count );
+		sorter.setThreads( _threads );
+		sorter.sort();
+		_comparisons += sorter.getComparisons();
+		_elements += count;
+		_runCount++;
+		const std::vector<int> & sorted = sorter.getSequence();
+		if ( count < chunk && _runs.empty() )
+		{
+			writeValues( output, &sorted[0], count, outputName );
+			return ;
+		}
+		std::FILE * file;
+		std::string path = _createRun( &file );
+		try
+		{
+			writeValues( file, &sorted[0], count, path );
+		}
+		catch ( ... )
+		{
+			std::fclose( file );
+			throw ;
+		}
+		closeWritten( file, path );
+		if ( count < chunk )
+		{
+			return ;
+		}
+	}
+}
+
+std::string ExternalSort::_createRun( std::FILE ** file )
+{
+	std::string pattern = _directory + "/PmergeMe-XXXXXX";
+	std::vector<char> path( pattern.begin(), pattern.end() );
+	path.push_back( '\0' );
+	int fd = mkstemp( &path[0] );
+	if ( fd < 0 )
+	{
+		throwError( _directory );
+	}
+	_runs.push_back( &path[0] );
+	*file = fdopen( fd, "wb" );
+	if ( *file == 0 )
+	{
+		close( fd );
+		throwError( _runs.back() );
+	}
+	return ( _runs.back() );
+}
+
+void ExternalSort::_removeRun( const std::string & path )
+{
+	unlink( path.c_str() );
+	_runs.erase( std::find( _runs.begin(), _runs.end(), path ) );
+}
+
+// The output buffer and one buffer per run split the budget evenly
+void ExternalSort::_merge( const std::vector<std::string> & runs, std::FILE * output,
+                           const std::string & outputName )
+{
+	size_t buffered = std::max( _budget / ( runs.size() + 1 ), MIN_BUFFER ) / sizeof( int );
+	std::vector<RunInput> inputs( runs.size() );
+	std::vector<int> merged( buffered );
+	size_t used = 0;
+	LoserTree tree( runs.size() );
+	try
+	{
+		for ( size_t i = 0; i < runs.size(); i++ )
+		{
+			inputs[i].file = std::fopen( runs[i].c_str(), "rb" );
+			if ( inputs[i].file == 0 )
+			{
+				throwError( runs[i] );
+			}
+			inputs[i].buffer.resize( buffered );
+			refill( inputs[i], runs[i] );
+			if ( inputs[i].count > 0 )
+			{
+				tree.set( i, inputs[i].buffer[inputs[i].position++] );
+			}
+		}
+		tree.build();
+		while ( !tree.isEmpty() )
+		{
+			merged[used++] = tree.getKey();
+			if ( used == buffered )
+			{
+				writeValues( output, &merged[0], used, outputName );
+				used = 0;
+			}
+			size_t way = tree.getWinner();
+			RunInput & run = inputs[way];
+			if ( run.position == run.count )
+			{
+				refill( run, runs[way] );
+			}
+			if ( run.position < run.count )
+			{
+				tree.replace( run.buffer[run.position++] );
+			}
+			else
+			{
+				tree.pop();
+			}
+		}
+		writeValues( output, &merged[0], used, outputName );
+	}
+	catch ( ... )
+	{
+		for ( size_t i = 0; i < inputs.size(); i++ )
+		{
+			if ( inputs[i].file != 0 )
+			{
+				std::fclose( inputs[i].file );
+			}
+		}
+		throw ;
+	}
+	for ( size_t i = 0; i < inputs.size(); i++ )
+	{
+		std::fclose( inputs[i].file );
+	}
+	_comparisons += tree.getComparisons();
+}
+
+size_t ExternalSort::getElements( void ) const
+{
+	return ( _elements );
+}
+
+size_t ExternalSort::getRuns( void ) const
+{
+	return ( _runCount );
+}
+
+size_t ExternalSort::getPasses( void ) const
+{
+	return ( _passes );
+}
+
+unsigned long ExternalSort::getComparisons( void ) const
+{
+	return ( _comparisons );
+}
@@ -0,0 +1,366 @@
+#include "InputLoader.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+static bool isSpace( char c )
+{
+	return ( c == ' ' || ( c >= '\t' && c <= '\r' ) );
+}
+
+static void throwOutOfRange( const std::string & token )
+{
+	std::stringstream intMax;
+	intMax << std::numeric_limits<int>::max();
+	throw ( std::out_of_range( token + ": must be a positive integer between 1 and " +
+	                           intMax.str() ) );
+}
+
+static void throwDuplicate( int value )
+{
+	std::stringstream ss;
+	ss << value << ": duplicate number";
+	throw ( std::out_of_range( ss.str() ) );
+}
+
+// Values per partition of the duplicate check
+static const size_t PARTITION_SIZE = 1 << 15;
+// Bitmaps and hash tables up to this size are checked without partitioning
+static const size_t CACHE_BYTES = 1 << 22;
+
+static void checkBitmap( const int * first, const int * last, long low, long high )
+{
+	std::vector<unsigned int> seen( ( high - low ) / 32 + 1, 0 );
+	for ( ; first != last; first++ )
+	{
+		long offset = *first - low;
+		unsigned int & word = seen[offset / 32];
+		unsigned int bit = 1U << ( offset % 32 );
+		if ( word & bit )
+		{
+			throwDuplicate( *first );
+		}
+		word |= bit;
+	}
+}
+
+// Open addressing with linear probing; 0 marks a free slot, values start at 1
+static void checkHash( const int * first, const int * last )
+{
+	size_t capacity = 1;
+	while ( capacity < 2 * static_cast<size_t>( last - first ) )
+	{
+		capacity *= 2;
+	}
+	std::vector<int> slots( capacity, 0 );
+	for ( ; first != last; first++ )
+	{
+		unsigned int hash = static_cast<unsigned int>( *first ) * 2654435769U;
+		size_t slot = ( hash ^ ( hash >> 16 ) ) & ( capacity - 1 );
+		while ( slots[slot] != 0 )
+		{
+			if ( slots[slot] == *first )
+			{
+				throwDuplicate( *first );
+			}
+			slot = ( slot + 1 ) & ( capacity - 1 );
+		}
+		slots[slot] = *first;
+	}
+}
+
+// A bitmap costs a bit per value in [low, high], the hash table 8 bytes per value
+static bool useBitmap( size_t count, long low, long high )
+{
+	return ( static_cast<size_t>( ( high - low ) / 64 ) <= count );
+}
+
+static void checkRange( const int * first, const int * last, long low, long high )
+{
+	if ( useBitmap( last - first, low, high ) )
+	{
+		checkBitmap( first, last, low, high );
+	}
+	else
+	{
+		checkHash( first, last );
+	}
+}
+
+const size_t InputLoader::CHUNK_SIZE;
+
+// Default constructor
+InputLoader::InputLoader( void ) {}
+
+// Copy constructor
+InputLoader::InputLoader( const InputLoader & src )
+{
+	*this = src;
+}
+
+// Destructor
+InputLoader::~InputLoader( void ) {}
+
+// Assignment operator
+InputLoader & InputLoader::operator=( const InputLoader & src )
+{
+	if ( this != &src )
+	{
+		_values = src._values;
+	}
+	return ( *this );
+}
+
+void InputLoader::loadArguments( int ac, char ** av )
+{
+	_values.clear();
+	for ( int i = 1; i < ac; i++ )
+	{
+		_parseText( av[i], av[i] + std::strlen( av[i] ) );
+	}
+	_checkValues();
+}
+
+void InputLoader::loadFile( const std::string & path, bool binary )
+{
+	std::FILE * file = stdin;
+	std::string name = "stdin";
+	if ( path != "-" )
+	{
+		file = std::fopen( path.c_str(), "rb" );
+		if ( file == 0 )
+		{
+			throw ( std::runtime_error( path + ": " + std::strerror( errno ) ) );
+		}
+		name = path;
+	}
+	_values.clear();
+	try
+	{
+		if ( binary )
+		{
+			_readBinary( file, name );
+		}
+		else
+		{
+			_readText( file, name );
+		}
+	}
+	catch ( ... )
+	{
+		if ( file != stdin )
+		{
+			std::fclose( file );
+		}
+		throw ;
+	}
+	if ( file != stdin )
+	{
+		std::fclose( file );
+	}
+	_checkValues();
+}
+
+const std::vector<int> & InputLoader::getValues( void ) const
+{
+	return ( _values );
+}
+
+// Accepts an optional '+' and decimal digits, nothing else, in one pass
+void InputLoader::_parseText( const char * first, const char * last )
+{
+	const int max = std::numeric_limits<int>::max();
+	const char * it = first;
+
+	while ( true )
+	{
+		while ( it != last && isSpace( *it ) )
+		{
+			it++;
+		}
+		if ( it == last )
+		{
+			return ;
+		}
+		const char * token = it;
+		if ( *it == '+' )
+		{
+			it++;
+		}
+		const char * digits = it;
+		while ( it != last && *it == '0' )
+		{
+			it++;
+		}
+		// Nine digits always fit in an int, only a tenth one needs a check
+		const char * significant = it;
+		int value = 0;
+		for ( ; it != last && it - significant < 9 && *it >= '0' && *it <= '9'; it++ )
+		{
+			value = value * 10 + ( *it - '0' );
+		}
+		bool overflow = false;
+		if ( it != last && *it >= '0' && *it <= '9' )
+		{
+			int digit = *it++ - '0';
+			overflow = value > ( max - digit ) / 10;
+			value = overflow ? max : value * 10 + digit;
+			overflow = overflow || ( it != last && *it >= '0' && *it <= '9' );
+		}
+		if ( it == digits || ( it != last && !isSpace( *it ) ) || overflow || value < 1 )
+		{
+			while ( it != last && !isSpace( *it ) )
+			{
+				it++;
+			}
+			throwOutOfRange( std::string( token, it ) );
+		}
+		_values.push_back( value );
+	}
+}
+
+// Parses whole tokens only; a token cut by the chunk end moves to the next one
+void InputLoader::_readText( std::FILE * file, const std::string & name )
+{
+	std::vector<char> buffer( CHUNK_SIZE );
+	size_t carry = 0;
+
+	while ( true )
+	{
+		size_t got = std::fread( &buffer[carry], 1, CHUNK_SIZE - carry, file );
+		size_t filled = carry + got;
+		if ( got == 0 )
+		{
+			if ( std::ferror( file ) )
+			{
+				throw ( std::runtime_error( name + ": read error" ) );
+			}
+			_parseText( &buffer[0], &buffer[0] + filled );
+			return ;
+		}
+		size_t cut = filled;
+		while ( cut > 0 && !isSpace( buffer[cut - 1] ) )
+		{
+			cut--;
+		}
+		if ( cut == 0 && filled == CHUNK_SIZE )
+		{
+			throwOutOfRange( std::string( &buffer[0], 32 ) + "..." );
+		}
+		_parseText( &buffer[0], &buffer[0] + cut );
+		std::copy( buffer.begin() + cut, buffer.begin() + filled, buffer.begin() );
+		carry = filled - cut;
+	}
+}
+
+// Reads straight into the value array, sized up front when the file can seek
+void InputLoader::_readBinary( std::FILE * file, const std::string & name )
+{
+	size_t bytes = 0;
+	if ( std::fseek( file, 0, SEEK_END ) == 0 )
+	{
+		long size = std::ftell( file );
+		std::rewind( file );
+		if ( size > 0 )
+		{
+			_values.resize( size / sizeof( int ) + 1 );
+		}
+	}
+	while ( true )
+	{
+		if ( _values.size() * sizeof( int ) == bytes )
+		{
+			_values.resize( std::max( _values.size() * 2, CHUNK_SIZE / sizeof( int ) ) );
+		}
+		size_t room = _values.size() * sizeof( int ) - bytes;
+		size_t got = std::fread( reinterpret_cast<char *>( &_values[0] ) + bytes, 1,
+		                         std::min( room, CHUNK_SIZE ), file );
+		bytes += got;
+		if ( got == 0 )
+		{
+			break ;
+		}
+	}
+	if ( std::ferror( file ) )
+	{
+		throw ( std::runtime_error( name + ": read error" ) );
+	}
+	if ( bytes % sizeof( int ) != 0 )
+	{
+		throw ( std::runtime_error( name + ": size is not a whole number of 32-bit integers" ) );
+	}
+	_values.resize( bytes / sizeof( int ) );
+}
+
+// Range check for binary input, which the text parser already did, then duplicates
+void InputLoader::_checkValues( void ) const
+{
+	if ( _values.empty() )
+	{
+		throw ( std::invalid_argument( "no integers to sort" ) );
+	}
+	int largest = 0;
+	for ( std::vector<int>::const_iterator it = _values.begin(); it != _values.end(); it++ )
+	{
+		if ( *it < 1 )
+		{
+			std::stringstream ss;
+			ss << *it;
+			throwOutOfRange( ss.str() );
+		}
+		largest = std::max( largest, *it );
+	}
+	_checkDuplicates( largest );
+}
+
+/*
+ * Inputs whose bitmap or hash table would not fit in cache are first split by
+ * value range into partitions of about PARTITION_SIZE values, so each
+ * partition's table stays in cache instead of taking a miss per value.
+ */
+void InputLoader::_checkDuplicates( int largest ) const
+{
+	size_t count = _values.size();
+	size_t bytes = useBitmap( count, 0, largest ) ? largest / 8 : count * 8;
+	if ( bytes <= CACHE_BYTES )
+	{
+		checkRange( &_values[0], &_values[0] + count, 0, largest );
+		return ;
+	}
+	size_t partitions = 1;
+	while ( count / partitions > PARTITION_SIZE )
+	{
+		partitions *= 2;
+	}
+	int shift = 0;
+	while ( static_cast<size_t>( largest >> shift ) >= partitions )
+	{
+		shift++;
+	}
+	partitions = ( largest >> shift ) + 1;
+	std::vector<size_t> start( partitions + 1, 0 );
+	std::vector<int>::const_iterator it;
+	for ( it = _values.begin(); it != _values.end(); it++ )
+	{
+		start[( *it >> shift ) + 1]++;
+	}
+	for ( size_t p = 0; p < partitions; p++ )
+	{
+		start[p + 1] += start[p];
+	}
+	std::vector<int> partitioned( count );
+	std::vector<size_t> next( start.begin(), start.end() - 1 );
+	for ( it = _values.begin(); it != _values.end(); it++ )
+	{
+		partitioned[next[*it >> shift]++] = *it;
+	}
+	for ( size_t p = 0; p < partitions; p++ )
+	{
+		long low = static_cast<long>( p ) << shift;
+		long high = std::min( static_cast<long>( largest ), ( low + ( 1L << shift ) ) - 1 );
+		checkRange( &partitioned[0] + start[p], &partitioned[0] + start[p + 1], low, high );
+	}
+}
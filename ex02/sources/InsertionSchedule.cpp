@@ -0,0 +1,116 @@
+#include "InsertionSchedule.hpp"
+#include <algorithm>
+
+/*
+ * Ford-Johnson group boundaries t_k = ( 2^(k+1) + (-1)^k ) / 3, i.e. the
+ * Jacobsthal numbers from J(2) on, up to the last one that fits in an int.
+ */
+static const int JACOBSTHAL[] = {
+	1, 3, 5, 11, 21, 43, 85, 171, 341, 683, 1365, 2731, 5461, 10923, 21845,
+	43691, 87381, 174763, 349525, 699051, 1398101, 2796203, 5592405,
+	11184811, 22369621, 44739243, 89478485, 178956971, 357913941,
+	715827883, 1431655765
+};
+static const int JACOBSTHAL_SIZE = sizeof( JACOBSTHAL ) / sizeof( JACOBSTHAL[0] );
+
+void buildInsertionSchedule( int pendingSize, std::vector<int> & schedule )
+{
+	if ( pendingSize < 1 )
+	{
+		return ;
+	}
+	schedule.reserve( schedule.size() + pendingSize );
+	schedule.push_back( 1 );
+	for ( int k = 1; k < JACOBSTHAL_SIZE && JACOBSTHAL[k - 1] < pendingSize; k++ )
+	{
+		int high = std::min( JACOBSTHAL[k], pendingSize );
+		for ( int index = high; index > JACOBSTHAL[k - 1]; index-- )
+		{
+			schedule.push_back( index );
+		}
+	}
+	// Any pendingSize in ( 1431655765, INT_MAX ] leaves one last group. The
+	// next boundary, 2863311531, does not fit in an int, so the group is
+	// clipped to pendingSize, the same as the loop does for smaller sizes.
+	if ( JACOBSTHAL[JACOBSTHAL_SIZE - 1] < pendingSize )
+	{
+		for ( int index = pendingSize; index > JACOBSTHAL[JACOBSTHAL_SIZE - 1]; index-- )
+		{
+			schedule.push_back( index );
+		}
+	}
+}
+
+// Default constructor
+PartnerWindows::PartnerWindows( void ) : _top( 0 ), _first( 0 ), _before( 0 ) {}
+
+// Copy constructor
+PartnerWindows::PartnerWindows( const PartnerWindows & src )
+{
+	*this = src;
+}
+
+// Destructor
+PartnerWindows::~PartnerWindows( void ) {}
+
+// Assignment operator
+PartnerWindows & PartnerWindows::operator=( const PartnerWindows & src )
+{
+	if ( this != &src )
+	{
+		_top = src._top;
+		_first = src._first;
+		_before = src._before;
+		_tree = src._tree;
+	}
+	return ( *this );
+}
+
+int PartnerWindows::open( int index, int partners )
+{
+	if ( index > _top )
+	{
+		_before = 2 * _top;
+		_first = _top;
+		_top = index;
+		_tree.assign( index - _first + 1, 0 );
+		for ( int i = 1; i < static_cast<int>( _tree.size() ); i++ )
+		{
+			_tree[i] = i & -i;
+		}
+	}
+	if ( index > partners )
+	{
+		return ( -1 );
+	}
+	int sum = 0;
+	for ( int i = index - _first; i > 0; i -= i & -i )
+	{
+		sum += _tree[i];
+	}
+	return ( _before + sum - 1 );
+}
+
+void PartnerWindows::inserted( int position )
+{
+	int size = _tree.size() - 1;
+	int target = position - _before + 1;
+	int step = 1;
+	while ( step * 2 <= size )
+	{
+		step *= 2;
+	}
+	int i = 0;
+	for ( ; step > 0; step /= 2 )
+	{
+		if ( i + step <= size && _tree[i + step] < target )
+		{
+			i += step;
+			target -= _tree[i];
+		}
+	}
+	for ( i++; i <= size; i += i & -i )
+	{
+		_tree[i]++;
+	}
+}
@@ -0,0 +1,129 @@
+#include "LoserTree.hpp"
+
+// Default constructor
+LoserTree::LoserTree( void ) : _ways( 0 ), _live( 0 ), _comparisons( 0 ) {}
+
+// Ways constructor
+LoserTree::LoserTree( size_t ways )
+	: _ways( ways ), _keys( ways, 0 ), _closed( ways, true ), _losers( ways, 0 ), _live( 0 ),
+	  _comparisons( 0 ) {}
+
+// Copy constructor
+LoserTree::LoserTree( const LoserTree & src )
+	: _ways( src._ways ), _keys( src._keys ), _closed( src._closed ), _losers( src._losers ),
+	  _live( src._live ), _comparisons( src._comparisons ) {}
+
+// Destructor
+LoserTree::~LoserTree( void ) {}
+
+// Assignment operator
+LoserTree & LoserTree::operator=( const LoserTree & src )
+{
+	if ( this != &src )
+	{
+		_ways = src._ways;
+		_keys = src._keys;
+		_closed = src._closed;
+		_losers = src._losers;
+		_live = src._live;
+		_comparisons = src._comparisons;
+	}
+	return ( *this );
+}
+
+// Closed ways lose every match without a comparison
+bool LoserTree::_beats( size_t a, size_t b )
+{
+	if ( _closed[b] )
+	{
+		return ( true );
+	}
+	if ( _closed[a] )
+	{
+		return ( false );
+	}
+	_comparisons++;
+	return ( _keys[a] < _keys[b] || ( !( _keys[b] < _keys[a] ) && a < b ) );
+}
+
+size_t LoserTree::_play( size_t node )
+{
+	if ( node >= _ways )
+	{
+		return ( node - _ways );
+	}
+	size_t left = _play( 2 * node );
+	size_t right = _play( 2 * node + 1 );
+	if ( _beats( left, right ) )
+	{
+		_losers[node] = right;
+		return ( left );
+	}
+	_losers[node] = left;
+	return ( right );
+}
+
+void LoserTree::_replay( size_t way )
+{
+	for ( size_t node = ( _ways + way ) / 2; node > 0; node /= 2 )
+	{
+		if ( _beats( _losers[node], way ) )
+		{
+			size_t winner = _losers[node];
+			_losers[node] = way;
+			way = winner;
+		}
+	}
+	_losers[0] = way;
+}
+
+void LoserTree::set( size_t way, int key )
+{
+	if ( _closed[way] )
+	{
+		_live++;
+	}
+	_keys[way] = key;
+	_closed[way] = false;
+}
+
+void LoserTree::build( void )
+{
+	if ( _ways > 0 )
+	{
+		_losers[0] = _play( 1 );
+	}
+}
+
+bool LoserTree::isEmpty( void ) const
+{
+	return ( _live == 0 );
+}
+
+size_t LoserTree::getWinner( void ) const
+{
+	return ( _losers[0] );
+}
+
+int LoserTree::getKey( void ) const
+{
+	return ( _keys[_losers[0]] );
+}
+
+void LoserTree::replace( int key )
+{
+	_keys[_losers[0]] = key;
+	_replay( _losers[0] );
+}
+
+void LoserTree::pop( void )
+{
+	_closed[_losers[0]] = true;
+	_live--;
+	_replay( _losers[0] );
+}
+
+unsigned long LoserTree::getComparisons( void ) const
+{
+	return ( _comparisons );
+}
@@ -0,0 +1,66 @@
+#include "NodeArena.hpp"
+#include <new>
+
+const size_t NodeArena::SLAB_SIZE;
+
+// Default constructor
+NodeArena::NodeArena( void ) : _slab( 0 ), _used( SLAB_SIZE ), _allocations( 0 ) {}
+
+// Destructor
+NodeArena::~NodeArena( void )
+{
+	release();
+}
+
+void * NodeArena::allocate( size_t bytes, size_t alignment )
+{
+	_allocations++;
+	if ( bytes > SLAB_SIZE )
+	{
+		_large.push_back( static_cast<char *>( ::operator new( bytes ) ) );
+		return ( _large.back() );
+	}
+	size_t offset = ( _used + alignment - 1 ) & ~( alignment - 1 );
+	if ( _slab == 0 || offset + bytes > SLAB_SIZE )
+	{
+		if ( _slab == _slabs.size() )
+		{
+			_slabs.push_back( static_cast<char *>( ::operator new( SLAB_SIZE ) ) );
+		}
+		_slab++;
+		offset = 0;
+	}
+	_used = offset + bytes;
+	return ( _slabs[_slab - 1] + offset );
+}
+
+void NodeArena::rewind( void )
+{
+	for ( size_t i = 0; i < _large.size(); i++ )
+	{
+		::operator delete( _large[i] );
+	}
+	_large.clear();
+	_slab = 0;
+	_used = SLAB_SIZE;
+}
+
+void NodeArena::release( void )
+{
+	rewind();
+	for ( size_t i = 0; i < _slabs.size(); i++ )
+	{
+		::operator delete( _slabs[i] );
+	}
+	_slabs.clear();
+}
+
+size_t NodeArena::getAllocations( void ) const
+{
+	return ( _allocations );
+}
+
+size_t NodeArena::getReservedBytes( void ) const
+{
+	return ( _slabs.size() * SLAB_SIZE );
+}
@@ -0,0 +1,140 @@
+#include "PairKernels.hpp"
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+# define PAIR_KERNELS_X86 1
+# include <immintrin.h>
+#else
+# define PAIR_KERNELS_X86 0
+#endif
+
+void pairIntScalar( const int * keys, int * smaller, int * larger, int * largerKeys,
+                    size_t first, size_t last )
+{
+	for ( size_t pair = first; pair < last; pair++ )
+	{
+		int a = 2 * pair;
+		int b = a + 1;
+		bool swap = keys[b] < keys[a];
+		smaller[pair] = swap ? b : a;
+		larger[pair] = swap ? a : b;
+		largerKeys[pair] = swap ? keys[a] : keys[b];
+	}
+}
+
+#if PAIR_KERNELS_X86
+
+/*
+ * Keys of 2p and 2p + 1 are split into an even and an odd vector. The
+ * compare mask is -1 where the pair swaps, so base - mask and
+ * base + 1 + mask give the smaller and larger item without a branch.
+ */
+__attribute__(( target( "sse4.1" ) ))
+void pairIntSse41( const int * keys, int * smaller, int * larger, int * largerKeys,
+                   size_t first, size_t last )
+{
+	size_t pair = first;
+	__m128i one = _mm_set1_epi32( 1 );
+	for ( ; pair + 4 <= last; pair += 4 )
+	{
+		__m128 low = _mm_castsi128_ps( _mm_loadu_si128(
+		                 reinterpret_cast<const __m128i *>( keys + 2 * pair ) ) );
+		__m128 high = _mm_castsi128_ps( _mm_loadu_si128(
+		                  reinterpret_cast<const __m128i *>( keys + 2 * pair + 4 ) ) );
+		__m128i even = _mm_castps_si128( _mm_shuffle_ps( low, high, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+		__m128i odd = _mm_castps_si128( _mm_shuffle_ps( low, high, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+		__m128i swap = _mm_cmpgt_epi32( even, odd );
+		int base = 2 * pair;
+		__m128i item = _mm_set_epi32( base + 6, base + 4, base + 2, base );
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( smaller + pair ),
+		                  _mm_sub_epi32( item, swap ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( larger + pair ),
+		                  _mm_add_epi32( _mm_add_epi32( item, one ), swap ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( largerKeys + pair ),
+		                  _mm_max_epi32( even, odd ) );
+	}
+	pairIntScalar( keys, smaller, larger, largerKeys, pair, last );
+}
+
+__attribute__(( target( "avx2" ) ))
+void pairIntAvx2( const int * keys, int * smaller, int * larger, int * largerKeys,
+                  size_t first, size_t last )
+{
+	size_t pair = first;
+	__m256i one = _mm256_set1_epi32( 1 );
+	for ( ; pair + 8 <= last; pair += 8 )
+	{
+		__m256 low = _mm256_castsi256_ps( _mm256_loadu_si256(
+		                 reinterpret_cast<const __m256i *>( keys + 2 * pair ) ) );
+		__m256 high = _mm256_castsi256_ps( _mm256_loadu_si256(
+		                  reinterpret_cast<const __m256i *>( keys + 2 * pair + 8 ) ) );
+		// The shuffle works per 128-bit lane, the permute restores item order
+		__m256i even = _mm256_permute4x64_epi64( _mm256_castps_si256(
+		                   _mm256_shuffle_ps( low, high, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ),
+		                   _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		__m256i odd = _mm256_permute4x64_epi64( _mm256_castps_si256(
+		                  _mm256_shuffle_ps( low, high, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ),
+		                  _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		__m256i swap = _mm256_cmpgt_epi32( even, odd );
+		int base = 2 * pair;
+		__m256i item = _mm256_set_epi32( base + 14, base + 12, base + 10, base + 8,
+		                                 base + 6, base + 4, base + 2, base );
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>( smaller + pair ),
+		                     _mm256_sub_epi32( item, swap ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>( larger + pair ),
+		                     _mm256_add_epi32( _mm256_add_epi32( item, one ), swap ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>( largerKeys + pair ),
+		                     _mm256_max_epi32( even, odd ) );
+	}
+	pairIntSse41( keys, smaller, larger, largerKeys, pair, last );
+}
+
+PairKernel selectPairKernel( const char ** name )
+{
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "avx2" ) )
+	{
+		if ( name )
+		{
+			*name = "avx2";
+		}
+		return ( &pairIntAvx2 );
+	}
+	if ( __builtin_cpu_supports( "sse4.1" ) )
+	{
+		if ( name )
+		{
+			*name = "sse4.1";
+		}
+		return ( &pairIntSse41 );
+	}
+	if ( name )
+	{
+		*name = "scalar";
+	}
+	return ( &pairIntScalar );
+}
+
+#else
+
+void pairIntSse41( const int * keys, int * smaller, int * larger, int * largerKeys,
+                   size_t first, size_t last )
+{
+	pairIntScalar( keys, smaller, larger, largerKeys, first, last );
+}
+
+void pairIntAvx2( const int * keys, int * smaller, int * larger, int * largerKeys,
+                  size_t first, size_t last )
+{
+	pairIntScalar( keys, smaller, larger, largerKeys, first, last );
+}
+
+PairKernel selectPairKernel( const char ** name )
+{
+	if ( name )
+	{
+		*name = "scalar";
+	}
+	return ( &pairIntScalar );
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include "Stopwatch.hpp"
+
+// Default constructor
+Stopwatch::Stopwatch( void ) : _wall( 0 ), _cpu( 0 )
+{
+	_wallStart.tv_sec = 0;
+	_wallStart.tv_nsec = 0;
+	_cpuStart = _wallStart;
+}
+
+// Copy constructor
+Stopwatch::Stopwatch( const Stopwatch & src )
+	: _wallStart( src._wallStart ), _cpuStart( src._cpuStart ), _wall( src._wall ),
+	  _cpu( src._cpu ) {}
+
+// Destructor
+Stopwatch::~Stopwatch( void ) {}
+
+// Assignment operator
+Stopwatch & Stopwatch::operator=( const Stopwatch & src )
+{
+	if ( this != &src )
+	{
+		_wallStart = src._wallStart;
+		_cpuStart = src._cpuStart;
+		_wall = src._wall;
+		_cpu = src._cpu;
+	}
+	return ( *this );
+}
+
+double Stopwatch::_elapsed( const struct timespec & from, const struct timespec & to )
+{
+	return ( ( to.tv_sec - from.tv_sec ) * 1e3 + ( to.tv_nsec - from.tv_nsec ) / 1e6 );
+}
+
+void Stopwatch::start( void )
+{
+	clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &_cpuStart );
+	clock_gettime( CLOCK_MONOTONIC, &_wallStart );
+}
+
+// Reads the clocks in the reverse order of start, so the wall interval
+// never includes the cost of reading the CPU clock
+void Stopwatch::stop( void )
+{
+	struct timespec wall;
+	struct timespec cpu;
+	clock_gettime( CLOCK_MONOTONIC, &wall );
+	clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &cpu );
+	_wall = _elapsed( _wallStart, wall );
+	_cpu = _elapsed( _cpuStart, cpu );
+}
+
+double Stopwatch::getWall( void ) const
+{
+	return ( _wall );
+}
+
+double Stopwatch::getCpu( void ) const
+{
+	return ( _cpu );
+}
@@ -0,0 +1,90 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool( int threads ) : _task( 0 ), _chunks( 0 ), _next( 0 ),
+	_completed( 0 ), _stop( false )
+{
+	pthread_mutex_init( &_mutex, 0 );
+	pthread_cond_init( &_wake, 0 );
+	pthread_cond_init( &_done, 0 );
+	for ( int i = 1; i < threads; i++ )
+	{
+		pthread_t worker;
+		if ( pthread_create( &worker, 0, &ThreadPool::_work, this ) != 0 )
+		{
+			break ;
+		}
+		_workers.push_back( worker );
+	}
+}
+
+ThreadPool::~ThreadPool( void )
+{
+	pthread_mutex_lock( &_mutex );
+	_stop = true;
+	pthread_cond_broadcast( &_wake );
+	pthread_mutex_unlock( &_mutex );
+	for ( size_t i = 0; i < _workers.size(); i++ )
+	{
+		pthread_join( _workers[i], 0 );
+	}
+	pthread_cond_destroy( &_done );
+	pthread_cond_destroy( &_wake );
+	pthread_mutex_destroy( &_mutex );
+}
+
+int ThreadPool::size( void ) const
+{
+	return ( _workers.size() + 1 );
+}
+
+void ThreadPool::run( Task & task, size_t chunks )
+{
+	pthread_mutex_lock( &_mutex );
+	_task = &task;
+	_chunks = chunks;
+	_next = 0;
+	_completed = 0;
+	pthread_cond_broadcast( &_wake );
+	_claimChunks();
+	while ( _completed < _chunks )
+	{
+		pthread_cond_wait( &_done, &_mutex );
+	}
+	_task = 0;
+	pthread_mutex_unlock( &_mutex );
+}
+
+void * ThreadPool::_work( void * pool )
+{
+	ThreadPool & self = *static_cast<ThreadPool *>( pool );
+
+	pthread_mutex_lock( &self._mutex );
+	while ( !self._stop )
+	{
+		if ( self._task == 0 || self._next >= self._chunks )
+		{
+			pthread_cond_wait( &self._wake, &self._mutex );
+			continue ;
+		}
+		self._claimChunks();
+	}
+	pthread_mutex_unlock( &self._mutex );
+	return ( 0 );
+}
+
+// Called with the mutex held; runs chunks unlocked until none are left
+void ThreadPool::_claimChunks( void )
+{
+	while ( _task != 0 && _next < _chunks )
+	{
+		Task * task = _task;
+		size_t chunk = _next++;
+		pthread_mutex_unlock( &_mutex );
+		task->run( chunk );
+		pthread_mutex_lock( &_mutex );
+		if ( ++_completed == _chunks )
+		{
+			pthread_cond_broadcast( &_done );
+		}
+	}
+}
@@ -1,12 +1,22 @@
 #include "PmergeMe.hpp"
 #include "utils.hpp"
+#include "InputLoader.hpp"
+#include "Benchmark.hpp"
+#include "ExternalSort.hpp"
+#include "Stopwatch.hpp"
+#include <cmath>
 #include <cstring>
+#include <fstream>
 
 int	main( int ac, char **av )
 {
 	if ( ac < 2 )
 	{
-		std::cerr << RED "Usage: ./PmergeMe [integers to sort]" RESET << std::endl;
+		std::cerr << RED "Usage: ./PmergeMe [-j threads] [integers to sort]" RESET << std::endl;
+		std::cerr << RED "       ./PmergeMe [-j threads] -f|-b file ( text or raw int32, - for stdin )" RESET << std::endl;
+		std::cerr << RED "       ./PmergeMe [-j threads] --bench elements [-r trials] [-w warmup] [-o file.json]" RESET << std::endl;
+		std::cerr << RED "                  [-m MiB [-x times] [-t directory]]" RESET << std::endl;
+		std::cerr << RED "       ./PmergeMe [-j threads] --external input output [-m MiB] [-t directory]" RESET << std::endl;
 		return ( 1 );
 	}
 	try
@@ -23,198 +33,282 @@ int	main( int ac, char **av )
 
 void testPmergeMe( int ac, char **av )
 {
-	int array_size = ac - 1;
-	int * array = getArrayToSort( array_size, av );
-	
-	std::clock_t vectorTime = test_vector( array, array_size );
-	std::clock_t listTime = test_list( array, array_size );
-	
-	std::cout << std::endl << CYAN "---- Timing" RESET << std::endl;
-	printTime("vector", vectorTime, ac - 1);
-	printTime("list", listTime, ac - 1);
-
-	delete [] array;
-}
-
-std::clock_t test_vector( int * array, int array_size)
-{
-	std::cout << CYAN "---- Insertion-merge sort with std::vector" RESET << std::endl;
-	PmergeMe vectorSorter( array, array_size, VECTOR );
-	std::clock_t start = std::clock();
-	vectorSorter.sort();
-	std::clock_t vectorTime = std::clock() - start;
-	verifySortAccuracy( array, array_size, vectorSorter.getSortedVector() );
-	return ( vectorTime );
-}
-
-std::clock_t test_list( int * array, int array_size )
-{
-	std::cout << std::endl << CYAN "---- Insertion-merge sort with std::list" RESET << std::endl;
-	PmergeMe listSorter( array, array_size, LIST );
-	std::clock_t start = std::clock();
-	listSorter.sort();
-	std::clock_t listTime = std::clock() - start;
-	verifySortAccuracy( array, array_size, listSorter.getSortedList() );
-	return ( listTime );
-}
-
-void printTime(std::string containerType, std::clock_t time, int elements)
-{
-	double clock_per_ms = static_cast<double>(CLOCKS_PER_SEC) / 1000;
-	double timeInMs = time / clock_per_ms;
-
-	std::cout << "Time to process a range of " << elements << " elements with std::"
-		<< containerType << ": " << time << " clock ticks (";
-	std::cout << std::fixed;
-	std::cout.precision( 6 );
-	std::cout << timeInMs << " ms)" << std::endl;
-}
-
-template <typename T>
-void verifySortAccuracy( int * array, int array_size, T & resultContainer )
-{
-	std::vector<int> * control = convertArrayToVector( array, array_size );
-
-	printContainer( *control, "Before Sort", RESET );
-	std::sort(control->begin(), control->end());
-
-	std::vector<int>::iterator controlit = control->begin();
-	typename T::iterator resultit = resultContainer.begin();
-	for ( ; resultit != resultContainer.end() && controlit != control->end(); controlit++)
+	int threads = 1;
+	const char * file = 0;
+	bool binary = false;
+	while ( ac > 2 && ( std::strcmp( av[1], "-j" ) == 0 || std::strcmp( av[1], "-f" ) == 0
+	                    || std::strcmp( av[1], "-b" ) == 0 ) )
 	{
-		if ( *resultit != *controlit )
+		if ( av[1][1] == 'j' )
 		{
-			printContainer( resultContainer, "After Sort", RED );
-			printContainer( *control, "Expected", CYAN );
-			std::cout << std::endl << RED BOLD ">>> KO: incorrectly sorted !" RESET << std::endl;
-			delete control;
-			return ;
+			threads = std::atoi( av[2] );
+			if ( threads < 1 )
+			{
+				throw ( std::out_of_range( std::string( av[2] ) + ": thread count must be positive" ) );
+			}
 		}
-		resultit++;
+		else
+		{
+			file = av[2];
+			binary = av[1][1] == 'b';
+		}
+		ac -= 2;
+		av += 2;
 	}
-	printContainer( resultContainer, "After Sort", GREEN );
-	std::cout << std::endl << GREEN BOLD ">>> OK: properly sorted." RESET << std::endl;
-	delete control;
-}
-
-int * getArrayToSort( int array_size, char **av )
-{
-	int * array = new int[array_size];
-	for (int x = 0; x < array_size; x++)
+	// Options may have consumed every argument, leaving av[1] null
+	InputLoader input;
+	if ( file != 0 )
 	{
-		array[x] = 0;
+		if ( ac > 1 )
+		{
+			throw ( std::invalid_argument( std::string( av[1] ) + ": numbers given along with a file" ) );
+		}
+		input.loadFile( file, binary );
 	}
-	for ( int i = 0; av[i + 1] && i < array_size; i++ )
+	else if ( ac > 1 && std::strcmp( av[1], "--bench" ) == 0 )
 	{
-		int nb = getNumber( av[i + 1], array, array_size );
-		array[i] = nb;
+		benchPmergeMe( ac - 1, av + 1, threads );
+		return ;
 	}
-	return ( array );
-}
-
-int getNumber( char * nbStr, int * array, int array_size )
-{
-	long nb = atol( nbStr );
-	std::stringstream intMax;
-	intMax << std::numeric_limits<int>::max();
-	if ( nb < 1 || nb > std::numeric_limits<int>::max() )
+	else if ( ac > 1 && std::strcmp( av[1], "--external" ) == 0 )
 	{
-		delete [] array;
-		throw ( std::out_of_range( std::string( nbStr ) +
-		                           ": must be a positive integer between 1 and " + intMax.str() ) );
+		externalPmergeMe( ac - 1, av + 1, threads );
+		return ;
 	}
-	if ( isADuplicate( array, array_size, nb ) )
+	else
 	{
-		delete [] array;
-		throw ( std::out_of_range( std::string( nbStr ) + ": duplicate number" ) );
+		input.loadArguments( ac, av );
 	}
-	return ( nb );
+	const std::vector<int> & values = input.getValues();
+	int array_size = values.size();
+	const int * array = &values[0];
+	printContainer( values, "Before Sort vector", RESET );
+	// Sorted once, the reference every backend is checked against
+	std::vector<int> expected( values );
+	std::sort( expected.begin(), expected.end() );
+	
+	Stopwatch vectorTime = testContainer< std::vector<int> >( array, array_size, expected,
+	                                                          "vector", threads );
+	Stopwatch dequeTime = testContainer< std::deque<int> >( array, array_size, expected,
+	                                                        "deque", threads );
+	Stopwatch listTime = testContainer< std::list<int> >( array, array_size, expected,
+	                                                      "list", threads );
+	
+	std::cout << CYAN "---- Timing" RESET << std::endl;
+	printTime("vector", vectorTime, array_size);
+	printTime("deque", dequeTime, array_size);
+	printTime("list", listTime, array_size);
 }
 
-bool isADuplicate( int * array, int array_size, int nb )
+/*
+ * Options after --bench: the input size, then -r timed trials, -w warmup
+ * trials and -o a JSON file to write the results to. -m adds external sort
+ * rows with that budget in MiB, over an input -x times as large written to
+ * the -t directory.
+ */
+void benchPmergeMe( int ac, char **av, int threads )
 {
-	for ( int i = 0; i < array_size; i++ )
+	if ( ac < 2 || std::atoi( av[1] ) < 1 )
+	{
+		throw ( std::invalid_argument( "--bench needs a positive number of elements" ) );
+	}
+	size_t elements = std::atoi( av[1] );
+	int trials = 11;
+	int warmup = 2;
+	const char * output = 0;
+	long megabytes = 0;
+	int times = 4;
+	std::string directory = std::getenv( "TMPDIR" ) ? std::getenv( "TMPDIR" ) : "/tmp";
+	for ( int i = 2; i < ac; i += 2 )
+	{
+		if ( i + 1 >= ac )
+		{
+			throw ( std::invalid_argument( std::string( av[i] ) + ": missing value" ) );
+		}
+		if ( std::strcmp( av[i], "-r" ) == 0 )
+		{
+			trials = std::atoi( av[i + 1] );
+		}
+		else if ( std::strcmp( av[i], "-w" ) == 0 )
+		{
+			warmup = std::atoi( av[i + 1] );
+		}
+		else if ( std::strcmp( av[i], "-o" ) == 0 )
+		{
+			output = av[i + 1];
+		}
+		else if ( std::strcmp( av[i], "-m" ) == 0 )
+		{
+			megabytes = std::atol( av[i + 1] );
+			if ( megabytes < 1 )
+			{
+				throw ( std::out_of_range( "memory budget must be at least 1 MiB" ) );
+			}
+		}
+		else if ( std::strcmp( av[i], "-x" ) == 0 )
+		{
+			times = std::atoi( av[i + 1] );
+		}
+		else if ( std::strcmp( av[i], "-t" ) == 0 )
+		{
+			directory = av[i + 1];
+		}
+		else
+		{
+			throw ( std::invalid_argument( std::string( av[i] ) + ": unknown option" ) );
+		}
+	}
+	if ( trials < 1 || warmup < 0 || times < 1 )
+	{
+		throw ( std::out_of_range( "trials and times must be positive and warmup not negative" ) );
+	}
+	Benchmark benchmark( elements, trials, warmup, threads );
+	benchmark.setExternal( static_cast<size_t>( megabytes ) << 20, times, directory );
+	benchmark.run();
+	benchmark.print( std::cout );
+	if ( output != 0 )
 	{
-		if ( array[i] == nb )
+		std::ofstream file( output );
+		if ( !file )
 		{
-			return ( true );
+			throw ( std::runtime_error( std::string( output ) + ": cannot open for writing" ) );
 		}
+		benchmark.writeJson( file );
 	}
-	return ( false );
 }
 
-std::vector<int> * convertArrayToVector( int * array, int array_size )
+/*
+ * Arguments after --external: the binary file to sort and the file to
+ * write, then -m the memory budget in MiB and -t the directory for runs
+ */
+void externalPmergeMe( int ac, char **av, int threads )
 {
-	std::vector<int> * vector = new std::vector<int>();
-	for ( int i = 0; i < array_size; i++ )
+	if ( ac < 3 )
 	{
-		vector->push_back(array[i]);
+		throw ( std::invalid_argument( "--external needs an input and an output file" ) );
 	}
-	return ( vector );
+	long megabytes = 64;
+	std::string directory = std::getenv( "TMPDIR" ) ? std::getenv( "TMPDIR" ) : "/tmp";
+	for ( int i = 3; i < ac; i += 2 )
+	{
+		if ( i + 1 >= ac )
+		{
+			throw ( std::invalid_argument( std::string( av[i] ) + ": missing value" ) );
+		}
+		if ( std::strcmp( av[i], "-m" ) == 0 )
+		{
+			megabytes = std::atol( av[i + 1] );
+		}
+		else if ( std::strcmp( av[i], "-t" ) == 0 )
+		{
+			directory = av[i + 1];
+		}
+		else
+		{
+			throw ( std::invalid_argument( std::string( av[i] ) + ": unknown option" ) );
+		}
+	}
+	if ( megabytes < 1 )
+	{
+		throw ( std::out_of_range( "memory budget must be at least 1 MiB" ) );
+	}
+	ExternalSort sorter( static_cast<size_t>( megabytes ) << 20, threads, directory );
+	Stopwatch stopwatch;
+	stopwatch.start();
+	sorter.sort( av[1], av[2] );
+	stopwatch.stop();
+	// Keeps stdout clean when the sorted data itself goes there
+	std::ostream & os = std::strcmp( av[2], "-" ) == 0 ? std::cerr : std::cout;
+	std::stringstream ss;
+	ss << sorter.getElements() << " in " << sorter.getRuns() << " runs, "
+		<< sorter.getPasses() << " merge passes, " << megabytes << " MiB budget";
+	os << CYAN << std::setw( 35 ) << std::left << "Elements: " << ss.str() << RESET << std::endl;
+	os << CYAN << std::setw( 35 ) << std::left << "Comparisons: " << sorter.getComparisons()
+		<< RESET << std::endl;
+	os << std::fixed;
+	os.precision( 3 );
+	os << "Time to sort externally: " << stopwatch.getWall() << " ms (CPU "
+		<< stopwatch.getCpu() << " ms)" << std::endl;
 }
 
-void printLine( std::string color, std::string key, std::string value)
+template <typename Container>
+Stopwatch testContainer( const int * array, int array_size, const std::vector<int> & expected,
+                         std::string containerType, int threads )
 {
-	std::cout << color << std::setw( 35 ) << std::left << key
-		<< value << RESET << std::endl;
+	std::cout << CYAN "---- Insertion-merge sort with std::" << containerType << RESET << std::endl;
+	PmergeMe<Container> sorter( array, array + array_size );
+	sorter.setThreads( threads );
+	Stopwatch stopwatch;
+	stopwatch.start();
+	sorter.sort();
+	stopwatch.stop();
+	verifySortAccuracy( expected, sorter.getSequence(), containerType );
+	printComparisons( sorter.getComparisons(), array_size );
+	std::cout << std::endl;
+	return ( stopwatch );
 }
 
-std::string getContentsAsString( std::vector<int> & vector )
+// One sample; see --bench for repeated trials and percentiles
+void printTime(std::string containerType, const Stopwatch & time, int elements)
 {
-	std::stringstream ss;
-	if ( vector.empty() )
-	{
-		return ( "" );
-	}
-	std::vector<int>::iterator it = vector.begin();
-	for ( ; it != vector.end(); it++ )
-	{
-		ss << "[" << *it << "]";
-	}
-	return ( ss.str() );
+	std::cout << "Time to process a range of " << elements << " elements with std::"
+		<< containerType << ": ";
+	std::cout << std::fixed;
+	std::cout.precision( 6 );
+	std::cout << time.getWall() << " ms (CPU " << time.getCpu() << " ms)" << std::endl;
 }
 
-std::string getContentsAsString( std::vector< std::pair<int, int> > & vector )
+/*
+ * Reports comparisons against ceil( log2( n! ) ), the minimum any comparison
+ * sort needs in the worst case, and against Ford-Johnson's own worst case
+ * F(n) = sum of ceil( log2( 3k / 4 ) ) for k = 1..n. The term is b for every
+ * k in ( 2^(b+1) / 3, 2^(b+2) / 3 ], so F(n) takes one step per bit.
+ */
+void printComparisons( unsigned long comparisons, int elements )
 {
-	std::stringstream ss;
-	if ( vector.empty() )
+	double log2Factorial = 0;
+	for ( int k = 2; k <= elements; k++ )
 	{
-		return ( "" );
+		log2Factorial += std::log( static_cast<double>( k ) ) / std::log( 2.0 );
 	}
-	std::vector< std::pair<int, int> >::iterator it = vector.begin();
-	for ( ; it != vector.end(); it++ )
+	unsigned long fordJohnson = 0;
+	unsigned long n = elements < 0 ? 0 : elements;
+	for ( unsigned long bits = 1; ( 2UL << bits ) / 3 < n; bits++ )
 	{
-		ss << "[" << it->first << "--"  << it->second << "]";
+		unsigned long first = ( 2UL << bits ) / 3 + 1;
+		unsigned long last = std::min( ( 4UL << bits ) / 3, n );
+		fordJohnson += bits * ( last - first + 1 );
 	}
-	return ( ss.str() );
+	std::stringstream ss;
+	ss << comparisons << " (ceil(log2(n!)) = "
+		<< static_cast<unsigned long>( std::ceil( log2Factorial - 1e-9 ) )
+		<< ", Ford-Johnson worst case = " << fordJohnson << ")";
+	printLine( CYAN, "Comparisons: ", ss.str() );
 }
 
-std::string getContentsAsString( std::list<int> & list )
+template <typename T>
+void verifySortAccuracy( const std::vector<int> & expected, const T & resultContainer,
+                         std::string containerType )
 {
-	std::stringstream ss;
-	if ( list.empty() )
-	{
-		return ( "" );
-	}
-	std::list<int>::iterator it = list.begin();
-	for ( ; it != list.end(); it++ )
+	std::vector<int>::const_iterator controlit = expected.begin();
+	typename T::const_iterator resultit = resultContainer.begin();
+	for ( ; resultit != resultContainer.end() && controlit != expected.end(); controlit++)
 	{
-		ss << "[" << *it << "]";
+		if ( *resultit != *controlit )
+		{
+			printContainer( resultContainer, "After Sort " + containerType, RED );
+			printContainer( expected, "Expected vector", CYAN );
+			std::cout << std::endl << RED BOLD ">>> KO: incorrectly sorted !" RESET << std::endl;
+			return ;
+		}
+		resultit++;
 	}
-	return ( ss.str() );
+	printContainer( resultContainer, "After Sort " + containerType, GREEN );
+	std::cout << std::endl << GREEN BOLD ">>> OK: properly sorted." RESET << std::endl;
 }
 
-std::string getContentsAsString( std::list< std::pair<int, int> > & list )
+void printLine( std::string color, std::string key, std::string value)
 {
-	std::stringstream ss;
-	if ( list.empty() )
-	{
-		return ( "" );
-	}
-	std::list< std::pair<int, int> >::iterator it = list.begin();
-	for ( ; it != list.end(); it++ )
-	{
-		ss << "[" << it->first << "--"  << it->second << "]";
-	}
-	return ( ss.str() );
+	std::cout << color << std::setw( 35 ) << std::left << key
+		<< value << RESET << std::endl;
 }